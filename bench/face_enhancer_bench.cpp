@@ -0,0 +1,302 @@
+#include "enhancement_algorithms.h"
+#include "utils.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Microbenchmarks for the EnhancementAlgorithms kernels.
+ * Every kernel runs over a matrix of image sizes, channel counts and
+ * OpenCV thread counts, with warmup runs and robust statistics (median and
+ * median absolute deviation). Results are written as CSV or JSON so two
+ * builds can be diffed.
+ */
+
+namespace {
+    struct Kernel {
+        std::string name;
+        std::function<cv::Mat(const cv::Mat&)> run;
+        bool colorOnly;  // needs 8UC3 input (photo module filters, skin model)
+    };
+
+    struct SizePreset {
+        std::string name;
+        cv::Size size;
+    };
+
+    struct Result {
+        std::string kernel;
+        std::string sizeName;
+        cv::Size size;
+        int channels = 0;
+        int threads = 0;
+        int reps = 0;
+        Utils::SampleStats stats;
+        double madMs = 0.0;
+        double megapixelsPerSecond = 0.0;
+    };
+
+    struct BenchOptions {
+        std::vector<std::string> sizes = {"vga", "1080p", "4k", "12mp"};
+        std::vector<int> channels = {1, 3};
+        std::vector<int> threads = {1, 0};  // 0 = every hardware thread
+        int warmup = 1;
+        int reps = 5;
+        std::string filter;
+        std::string format = "csv";
+        std::string outputPath;
+        unsigned int seed = 12345;
+    };
+
+    const std::vector<SizePreset> kSizePresets = {
+        {"vga", cv::Size(640, 480)},
+        {"1080p", cv::Size(1920, 1080)},
+        {"4k", cv::Size(3840, 2160)},
+        {"12mp", cv::Size(4000, 3000)},
+    };
+
+    // Keeps results observable so the optimiser can't drop a kernel call
+    volatile double sink = 0.0;
+
+    std::vector<Kernel> registerKernels() {
+        // A centred face-sized rectangle for the face-restricted kernels
+        auto centreFace = [](const cv::Mat& image) {
+            int side = std::min(image.cols, image.rows) / 2;
+            return std::vector<cv::Rect>{cv::Rect((image.cols - side) / 2, (image.rows - side) / 2, side, side)};
+        };
+
+        return {
+            {"unsharpMask", [](const cv::Mat& m) { return EnhancementAlgorithms::unsharpMask(m); }, false},
+            {"laplacianSharpen", [](const cv::Mat& m) { return EnhancementAlgorithms::laplacianSharpen(m); }, false},
+            {"highPassSharpen", [](const cv::Mat& m) { return EnhancementAlgorithms::highPassSharpen(m); }, false},
+            {"bilateralFilter", [](const cv::Mat& m) { return EnhancementAlgorithms::bilateralFilter(m); }, false},
+            {"nonLocalMeansDenoising", [](const cv::Mat& m) { return EnhancementAlgorithms::nonLocalMeansDenoising(m); }, false},
+            {"guidedFilter", [](const cv::Mat& m) { return EnhancementAlgorithms::guidedFilter(m, cv::Mat()); }, false},
+            {"edgePreservingFilter", [](const cv::Mat& m) { return EnhancementAlgorithms::edgePreservingFilter(m); }, true},
+            {"detailEnhance", [](const cv::Mat& m) { return EnhancementAlgorithms::detailEnhance(m); }, true},
+            {"pencilSketch", [](const cv::Mat& m) { return EnhancementAlgorithms::pencilSketch(m); }, true},
+            {"adaptiveHistogramEqualization", [](const cv::Mat& m) { return EnhancementAlgorithms::adaptiveHistogramEqualization(m); }, false},
+            {"gammaCorrection", [](const cv::Mat& m) { return EnhancementAlgorithms::gammaCorrection(m, 1.2); }, false},
+            {"retinexSSR", [](const cv::Mat& m) { return EnhancementAlgorithms::retinexSSR(m); }, false},
+            {"retinexMSR", [](const cv::Mat& m) { return EnhancementAlgorithms::retinexMSR(m); }, false},
+            {"bicubicUpscale", [](const cv::Mat& m) { return EnhancementAlgorithms::bicubicUpscale(m); }, false},
+            {"lanczosUpscale", [](const cv::Mat& m) { return EnhancementAlgorithms::lanczosUpscale(m); }, false},
+            {"edgeDirectedInterpolation", [](const cv::Mat& m) { return EnhancementAlgorithms::edgeDirectedInterpolation(m); }, true},
+            {"skinSmoothing", [centreFace](const cv::Mat& m) { return EnhancementAlgorithms::skinSmoothing(m, centreFace(m)); }, true},
+            {"createSkinMask", [](const cv::Mat& m) { return EnhancementAlgorithms::createSkinMask(m); }, true},
+        };
+    }
+
+    // Smooth structure plus sensor-like noise, so data-dependent kernels do representative work
+    cv::Mat makeInput(const cv::Size& size, int channels, unsigned int seed) {
+        cv::setRNGSeed(static_cast<int>(seed));
+        cv::Mat coarse(std::max(1, size.height / 32), std::max(1, size.width / 32), CV_8UC(channels));
+        cv::randu(coarse, cv::Scalar::all(40), cv::Scalar::all(220));
+
+        cv::Mat image;
+        cv::resize(coarse, image, size, 0, 0, cv::INTER_CUBIC);
+
+        cv::Mat noise(size, CV_16SC(channels));
+        cv::randn(noise, cv::Scalar::all(0), cv::Scalar::all(8));
+        cv::Mat noisy;
+        image.convertTo(noisy, CV_16S);
+        noisy += noise;
+        noisy.convertTo(image, CV_8U);
+        return image;
+    }
+
+    double medianAbsoluteDeviation(const std::vector<double>& samples, double median) {
+        std::vector<double> deviations;
+        for (double s : samples) deviations.push_back(std::abs(s - median));
+        return Utils::SampleStats::of(deviations).p50;
+    }
+
+    Result measure(const Kernel& kernel, const SizePreset& preset, const cv::Mat& input, int threads,
+                   const BenchOptions& options) {
+        for (int i = 0; i < options.warmup; ++i) {
+            sink = sink + kernel.run(input).total();
+        }
+
+        std::vector<double> samples;
+        for (int i = 0; i < options.reps; ++i) {
+            auto start = std::chrono::high_resolution_clock::now();
+            cv::Mat output = kernel.run(input);
+            samples.push_back(Utils::getElapsedTime(start));
+            sink = sink + output.total();
+        }
+
+        Result result;
+        result.kernel = kernel.name;
+        result.sizeName = preset.name;
+        result.size = preset.size;
+        result.channels = input.channels();
+        result.threads = threads;
+        result.reps = options.reps;
+        result.stats = Utils::SampleStats::of(samples);
+        result.madMs = medianAbsoluteDeviation(samples, result.stats.p50);
+        if (result.stats.p50 > 0.0) {
+            result.megapixelsPerSecond = preset.size.area() / 1e6 / (result.stats.p50 / 1000.0);
+        }
+        return result;
+    }
+
+    std::vector<int> parseIntList(const std::string& text) {
+        std::vector<int> values;
+        for (const auto& part : Utils::split(text, ',')) {
+            if (!Utils::trim(part).empty()) values.push_back(std::stoi(part));
+        }
+        return values;
+    }
+
+    void writeCsv(std::ostream& out, const std::vector<Result>& results) {
+        out << std::setprecision(6);
+        out << "kernel,size,width,height,channels,threads,reps,median_ms,mad_ms,min_ms,mean_ms,p95_ms,max_ms,mpix_per_s\n";
+        for (const auto& r : results) {
+            out << r.kernel << ',' << r.sizeName << ',' << r.size.width << ',' << r.size.height << ','
+                << r.channels << ',' << r.threads << ',' << r.reps << ','
+                << r.stats.p50 << ',' << r.madMs << ',' << r.stats.min << ',' << r.stats.mean << ','
+                << r.stats.p95 << ',' << r.stats.max << ',' << r.megapixelsPerSecond << '\n';
+        }
+    }
+
+    void writeJson(std::ostream& out, const std::vector<Result>& results) {
+        out << std::setprecision(6);
+        out << "{\n";
+        out << "  \"opencv\": \"" << CV_VERSION << "\",\n";
+        out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+        out << "  \"timestamp\": \"" << Utils::getCurrentTimestamp() << "\",\n";
+        out << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+            out << "    {\"kernel\": \"" << r.kernel << "\", \"size\": \"" << r.sizeName << "\""
+                << ", \"width\": " << r.size.width << ", \"height\": " << r.size.height
+                << ", \"channels\": " << r.channels << ", \"threads\": " << r.threads << ", \"reps\": " << r.reps
+                << ", \"median_ms\": " << r.stats.p50 << ", \"mad_ms\": " << r.madMs
+                << ", \"min_ms\": " << r.stats.min << ", \"mean_ms\": " << r.stats.mean
+                << ", \"p95_ms\": " << r.stats.p95 << ", \"max_ms\": " << r.stats.max
+                << ", \"mpix_per_s\": " << r.megapixelsPerSecond << "}"
+                << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n";
+        out << "}\n";
+    }
+
+    void printUsage(const std::string& programName) {
+        std::cout << "Usage: " << programName << " [OPTIONS]\n\n";
+        std::cout << "  --sizes LIST      Comma-separated presets: vga, 1080p, 4k, 12mp (default: all)\n";
+        std::cout << "  --channels LIST   Channel counts, 1 and/or 3 (default: 1,3)\n";
+        std::cout << "  --threads LIST    OpenCV thread counts, 0 = all cores (default: 1,0)\n";
+        std::cout << "  --warmup INT      Untimed runs before measuring (default: 1)\n";
+        std::cout << "  --reps INT        Timed runs per configuration (default: 5)\n";
+        std::cout << "  --filter TEXT     Only kernels whose name contains TEXT\n";
+        std::cout << "  --format FMT      csv or json (default: csv)\n";
+        std::cout << "  --output FILE     Write results to FILE instead of stdout\n";
+        std::cout << "  --seed INT        Seed for the synthetic inputs (default: 12345)\n";
+        std::cout << "  --list            List kernels and exit\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        BenchOptions options;
+        std::vector<Kernel> kernels = registerKernels();
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-h" || arg == "--help") {
+                printUsage(argv[0]);
+                return 0;
+            } else if (arg == "--list") {
+                for (const auto& kernel : kernels) std::cout << kernel.name << "\n";
+                return 0;
+            } else if (arg == "--sizes" && i + 1 < argc) {
+                options.sizes = Utils::split(Utils::toLowerCase(argv[++i]), ',');
+            } else if (arg == "--channels" && i + 1 < argc) {
+                options.channels = parseIntList(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                options.threads = parseIntList(argv[++i]);
+            } else if (arg == "--warmup" && i + 1 < argc) {
+                options.warmup = std::max(0, std::stoi(argv[++i]));
+            } else if (arg == "--reps" && i + 1 < argc) {
+                options.reps = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--filter" && i + 1 < argc) {
+                options.filter = argv[++i];
+            } else if (arg == "--format" && i + 1 < argc) {
+                options.format = Utils::toLowerCase(argv[++i]);
+            } else if (arg == "--output" && i + 1 < argc) {
+                options.outputPath = argv[++i];
+            } else if (arg == "--seed" && i + 1 < argc) {
+                options.seed = static_cast<unsigned int>(std::stoul(argv[++i]));
+            } else {
+                std::cerr << "Unknown option: " << arg << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        // Progress goes to stderr so stdout stays machine-readable
+        Utils::setLogStream(std::cerr);
+        Utils::setLogLevel(Utils::LOG_WARNING);
+
+        std::vector<Result> results;
+        for (const auto& sizeName : options.sizes) {
+            auto preset = std::find_if(kSizePresets.begin(), kSizePresets.end(),
+                                       [&sizeName](const SizePreset& p) { return p.name == Utils::trim(sizeName); });
+            if (preset == kSizePresets.end()) {
+                std::cerr << "Unknown size preset: " << sizeName << "\n";
+                return 1;
+            }
+
+            for (int channels : options.channels) {
+                if (channels != 1 && channels != 3) {
+                    std::cerr << "Unsupported channel count: " << channels << "\n";
+                    return 1;
+                }
+                cv::Mat input = makeInput(preset->size, channels, options.seed);
+
+                for (int threads : options.threads) {
+                    int effectiveThreads = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+                    cv::setNumThreads(effectiveThreads);
+
+                    for (const auto& kernel : kernels) {
+                        if (!options.filter.empty() && kernel.name.find(options.filter) == std::string::npos) continue;
+                        if (kernel.colorOnly && channels != 3) continue;
+
+                        std::cerr << kernel.name << " " << preset->name << " c" << channels
+                                  << " t" << effectiveThreads << "..." << std::flush;
+                        results.push_back(measure(kernel, *preset, input, effectiveThreads, options));
+                        std::cerr << " " << results.back().stats.p50 << " ms\n";
+                    }
+                }
+            }
+        }
+
+        std::ofstream file;
+        if (!options.outputPath.empty()) {
+            file.open(options.outputPath);
+            if (!file.is_open()) {
+                std::cerr << "Could not write results: " << options.outputPath << "\n";
+                return 1;
+            }
+        }
+        std::ostream& out = options.outputPath.empty() ? std::cout : file;
+        if (options.format == "json") {
+            writeJson(out, results);
+        } else {
+            writeCsv(out, results);
+        }
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in benchmark: " << e.what() << "\n";
+        return 1;
+    }
+}
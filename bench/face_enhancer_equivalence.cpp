@@ -0,0 +1,423 @@
+#include "enhancement_algorithms.h"
+#include "image_processor.h"
+#include "image_stats.h"
+#include "ssim_engine.h"
+#include "utils.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Reference-vs-optimized equivalence harness.
+ * Each kernel registers a reference implementation (plain OpenCV calls)
+ * and any number of faster variants. Every variant runs on randomized and
+ * real images across types and sizes, is checked against the reference
+ * for max-abs-error, relative error and PSNR tolerances, and is timed in
+ * the same run so a speedup never hides a quality drift. Exits non-zero
+ * when any variant is out of tolerance.
+ */
+
+namespace {
+    // Kernels return an image, or a 1xN CV_64F row of scalar results
+    using KernelFn = std::function<cv::Mat(const cv::Mat&)>;
+
+    struct Variant {
+        std::string name;
+        KernelFn run;
+    };
+
+    struct Tolerance {
+        double maxAbsError = 0.0;       // largest per-element difference allowed
+        double maxRelativeError = 0.0;  // for scalar results; 0 = not checked
+        double minPsnr = 0.0;           // for image results; 0 = not checked
+    };
+
+    struct KernelCase {
+        std::string name;
+        Variant reference;
+        std::vector<Variant> variants;
+        Tolerance tolerance;
+        std::vector<int> types;
+    };
+
+    struct TestInput {
+        std::string name;
+        cv::Mat image;
+    };
+
+    struct Comparison {
+        double maxAbsError = 0.0;
+        double maxRelativeError = 0.0;
+        double psnr = 0.0;
+        bool sizeMismatch = false;
+    };
+
+    cv::Mat scalars(std::initializer_list<double> values) {
+        cv::Mat row(1, static_cast<int>(values.size()), CV_64F);
+        int i = 0;
+        for (double v : values) row.at<double>(0, i++) = v;
+        return row;
+    }
+
+    cv::Mat toLuma(const cv::Mat& image) {
+        cv::Mat gray;
+        if (image.channels() == 3) {
+            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+        } else {
+            gray = image;
+        }
+        return gray;
+    }
+
+    // Statistics are defined on the 8-bit scale: 16-bit inputs span the full range, floats [0, 1]
+    double eightBitScale(int depth) {
+        if (depth == CV_16U) return 1.0 / 257.0;
+        if (depth == CV_32F) return 255.0;
+        return 1.0;
+    }
+
+    cv::Mat toEightBit(const cv::Mat& image) {
+        if (image.depth() == CV_8U) return image;
+        cv::Mat converted;
+        image.convertTo(converted, CV_8U, eightBitScale(image.depth()));
+        return converted;
+    }
+
+    // Full-resolution Gaussian SSIM on luma: five whole-image blurs, the textbook formulation
+    double referenceSsim(const cv::Mat& first, const cv::Mat& second) {
+        cv::Mat x, y;
+        toLuma(first).convertTo(x, CV_32F);
+        toLuma(second).convertTo(y, CV_32F);
+
+        const cv::Size window(11, 11);
+        const double sigma = 1.5, C1 = 6.5025, C2 = 58.5225;
+        cv::Mat mu1, mu2, xx, yy, xy;
+        cv::GaussianBlur(x, mu1, window, sigma);
+        cv::GaussianBlur(y, mu2, window, sigma);
+        cv::GaussianBlur(x.mul(x), xx, window, sigma);
+        cv::GaussianBlur(y.mul(y), yy, window, sigma);
+        cv::GaussianBlur(x.mul(y), xy, window, sigma);
+
+        cv::Mat mu1mu2 = mu1.mul(mu2), mu1sq = mu1.mul(mu1), mu2sq = mu2.mul(mu2);
+        cv::Mat numerator = (2 * mu1mu2 + C1).mul(2 * (xy - mu1mu2) + C2);
+        cv::Mat denominator = (mu1sq + mu2sq + C1).mul((xx - mu1sq) + (yy - mu2sq) + C2);
+        cv::Mat map;
+        cv::divide(numerator, denominator, map);
+        return cv::mean(map)[0];
+    }
+
+    // A second image for two-input kernels: the input with a deterministic blur and offset
+    cv::Mat companion(const cv::Mat& image) {
+        cv::Mat other;
+        cv::GaussianBlur(image, other, cv::Size(5, 5), 1.2);
+        other.convertTo(other, -1, 0.9, 12.0);
+        return other;
+    }
+
+    std::vector<KernelCase> registerKernels() {
+        std::vector<KernelCase> kernels;
+        const std::vector<int> grayAndColor = {CV_8UC1, CV_8UC3};
+        const std::vector<int> allDepths = {CV_8UC1, CV_8UC3, CV_16UC1, CV_16UC3, CV_32FC1, CV_32FC3};
+
+        {
+            KernelCase k;
+            k.name = "ssim";
+            k.reference = {"full_resolution", [](const cv::Mat& m) { return scalars({referenceSsim(m, companion(m))}); }};
+            k.variants.push_back({"engine_default", [](const cv::Mat& m) {
+                return scalars({SSIMEngine::ssim(m, companion(m))});
+            }});
+            k.variants.push_back({"engine_single_row_bands", [](const cv::Mat& m) {
+                SSIMEngine::Options options;
+                options.bandRows = 1;
+                return scalars({SSIMEngine::ssim(m, companion(m), options)});
+            }});
+            k.variants.push_back({"engine_odd_bands", [](const cv::Mat& m) {
+                SSIMEngine::Options options;
+                options.bandRows = 7;
+                return scalars({SSIMEngine::ssim(m, companion(m), options)});
+            }});
+            k.tolerance.maxAbsError = 1e-4;
+            k.types = grayAndColor;
+            kernels.push_back(k);
+        }
+
+        {
+            KernelCase k;
+            k.name = "sharpness";
+            k.reference = {"laplacian_variance", [](const cv::Mat& m) {
+                cv::Mat laplacian;
+                cv::Laplacian(toLuma(toEightBit(m)), laplacian, CV_64F);
+                cv::Scalar mean, stddev;
+                cv::meanStdDev(laplacian, mean, stddev);
+                return scalars({stddev[0] * stddev[0]});
+            }};
+            k.variants.push_back({"image_stats", [](const cv::Mat& m) {
+                return scalars({ImageStats::compute(m).sharpness});
+            }});
+            k.tolerance.maxRelativeError = 1e-9;
+            k.types = allDepths;
+            kernels.push_back(k);
+        }
+
+        {
+            KernelCase k;
+            k.name = "luma_moments";
+            k.reference = {"mean_stddev", [](const cv::Mat& m) {
+                cv::Scalar mean, stddev;
+                cv::meanStdDev(toLuma(toEightBit(m)), mean, stddev);
+                return scalars({mean[0], stddev[0]});
+            }};
+            k.variants.push_back({"image_stats", [](const cv::Mat& m) {
+                ImageStats stats = ImageStats::compute(m);
+                return scalars({stats.brightness, stats.contrast});
+            }});
+            k.tolerance.maxAbsError = 1e-6;
+            k.types = allDepths;
+            kernels.push_back(k);
+        }
+
+        {
+            KernelCase k;
+            k.name = "unsharpMask";
+            k.reference = {"opencv_composition", [](const cv::Mat& m) {
+                cv::Mat blurred, mask, sharpened;
+                cv::GaussianBlur(m, blurred, cv::Size(7, 7), 1.0);
+                cv::subtract(m, blurred, mask);
+                cv::addWeighted(m, 1.0, mask, 1.5, 0, sharpened);
+                return sharpened;
+            }};
+            k.variants.push_back({"enhancement_algorithms", [](const cv::Mat& m) {
+                return EnhancementAlgorithms::unsharpMask(m, 1.5, 1.0);
+            }});
+            k.tolerance.maxAbsError = 1.0;
+            k.tolerance.minPsnr = 50.0;
+            k.types = grayAndColor;
+            kernels.push_back(k);
+        }
+
+        {
+            KernelCase k;
+            k.name = "crop";
+            k.reference = {"deep_copy", [](const cv::Mat& m) {
+                return m(cv::Rect(m.cols / 4, m.rows / 4, std::max(1, m.cols / 2), std::max(1, m.rows / 2))).clone();
+            }};
+            k.variants.push_back({"crop_image", [](const cv::Mat& m) {
+                return ImageProcessor::cropImage(m, cv::Rect(m.cols / 4, m.rows / 4, std::max(1, m.cols / 2), std::max(1, m.rows / 2)));
+            }});
+            k.types = grayAndColor;
+            kernels.push_back(k);
+        }
+
+        return kernels;
+    }
+
+    std::vector<TestInput> makeInputs(int type, const std::vector<cv::Mat>& realImages, unsigned int seed) {
+        // Odd and tiny sizes exercise border handling and band remainders
+        const std::vector<cv::Size> sizes = {cv::Size(3, 2), cv::Size(17, 13), cv::Size(333, 191),
+                                             cv::Size(640, 480), cv::Size(1920, 1080)};
+        // Inputs are drawn at 8 bits and widened, so every depth carries the same levels
+        const int eightBitType = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
+        const double widen = 1.0 / eightBitScale(CV_MAT_DEPTH(type));
+        auto atDepth = [&](const cv::Mat& image) {
+            if (image.type() == type) return image;
+            cv::Mat widened;
+            image.convertTo(widened, type, widen);
+            return widened;
+        };
+
+        std::vector<TestInput> inputs;
+        cv::setRNGSeed(static_cast<int>(seed));
+
+        for (const auto& size : sizes) {
+            std::string label = std::to_string(size.width) + "x" + std::to_string(size.height);
+
+            cv::Mat noise(size, eightBitType);
+            cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(256));
+            inputs.push_back({"uniform_" + label, atDepth(noise)});
+
+            cv::Mat coarse(std::max(1, size.height / 16), std::max(1, size.width / 16), eightBitType);
+            cv::randu(coarse, cv::Scalar::all(30), cv::Scalar::all(225));
+            cv::Mat smooth;
+            cv::resize(coarse, smooth, size, 0, 0, cv::INTER_CUBIC);
+            inputs.push_back({"smooth_" + label, atDepth(smooth)});
+
+            inputs.push_back({"constant_" + label, atDepth(cv::Mat(size, eightBitType, cv::Scalar::all(128)))});
+        }
+
+        for (size_t i = 0; i < realImages.size(); ++i) {
+            cv::Mat image = realImages[i];
+            if (CV_MAT_CN(type) == 1 && image.channels() == 3) {
+                cv::cvtColor(image, image, cv::COLOR_BGR2GRAY);
+            }
+            inputs.push_back({"real_" + std::to_string(i), atDepth(image)});
+        }
+        return inputs;
+    }
+
+    Comparison compare(const cv::Mat& reference, const cv::Mat& candidate) {
+        Comparison result;
+        if (reference.size() != candidate.size() || reference.channels() != candidate.channels()) {
+            result.sizeMismatch = true;
+            return result;
+        }
+
+        cv::Mat a, b, diff;
+        reference.convertTo(a, CV_64F);
+        candidate.convertTo(b, CV_64F);
+        cv::absdiff(a, b, diff);
+        result.maxAbsError = cv::norm(diff, cv::NORM_INF);
+
+        cv::Mat magnitude = cv::abs(a);
+        cv::Mat relative;
+        cv::divide(diff, cv::max(magnitude, 1e-12), relative);
+        result.maxRelativeError = cv::norm(relative, cv::NORM_INF);
+
+        double mse = cv::mean(diff.mul(diff))[0];
+        result.psnr = mse < 1e-10 ? 100.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+        return result;
+    }
+
+    double medianTime(const KernelFn& fn, const cv::Mat& input, int reps, cv::Mat& output) {
+        std::vector<double> samples;
+        for (int i = 0; i < reps; ++i) {
+            auto start = std::chrono::high_resolution_clock::now();
+            output = fn(input);
+            samples.push_back(Utils::getElapsedTime(start));
+        }
+        return Utils::SampleStats::of(samples).p50;
+    }
+
+    bool withinTolerance(const Comparison& c, const Tolerance& t, bool scalarResult) {
+        if (c.sizeMismatch) return false;
+        if (scalarResult && t.maxRelativeError > 0.0) {
+            return c.maxRelativeError <= t.maxRelativeError || c.maxAbsError <= t.maxAbsError;
+        }
+        if (c.maxAbsError > t.maxAbsError) return false;
+        return scalarResult || t.minPsnr <= 0.0 || c.psnr >= t.minPsnr;
+    }
+
+    std::string typeName(int type) {
+        const int depth = CV_MAT_DEPTH(type);
+        std::string name = depth == CV_16U ? "16U" : (depth == CV_32F ? "32F" : "8U");
+        return name + "C" + std::to_string(CV_MAT_CN(type));
+    }
+
+    void printUsage(const std::string& programName) {
+        std::cout << "Usage: " << programName << " [OPTIONS]\n\n";
+        std::cout << "  --images DIR   Real images to test alongside the synthetic ones\n";
+        std::cout << "  --filter TEXT  Only kernels whose name contains TEXT\n";
+        std::cout << "  --reps INT     Timed runs per variant and input (default: 3)\n";
+        std::cout << "  --seed INT     Seed for the synthetic inputs (default: 7)\n";
+        std::cout << "  --verbose      Print every comparison, not just failures\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::string imagesDir, filter;
+        int reps = 3;
+        unsigned int seed = 7;
+        bool verbose = false;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-h" || arg == "--help") {
+                printUsage(argv[0]);
+                return 0;
+            } else if (arg == "--images" && i + 1 < argc) {
+                imagesDir = argv[++i];
+            } else if (arg == "--filter" && i + 1 < argc) {
+                filter = argv[++i];
+            } else if (arg == "--reps" && i + 1 < argc) {
+                reps = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--seed" && i + 1 < argc) {
+                seed = static_cast<unsigned int>(std::stoul(argv[++i]));
+            } else if (arg == "--verbose") {
+                verbose = true;
+            } else {
+                std::cerr << "Unknown option: " << arg << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        Utils::setLogLevel(Utils::LOG_WARNING);
+
+        std::vector<cv::Mat> realImages;
+        if (!imagesDir.empty()) {
+            for (const auto& file : ImageProcessor::getImagesInDirectory(imagesDir)) {
+                cv::Mat image = ImageProcessor::loadImage(file);
+                if (!image.empty()) realImages.push_back(image);
+            }
+        }
+
+        int failures = 0;
+        std::cout << std::setprecision(6);
+        for (const auto& kernel : registerKernels()) {
+            if (!filter.empty() && kernel.name.find(filter) == std::string::npos) continue;
+
+            // Per variant: worst error seen and total time against the reference
+            std::map<std::string, Comparison> worst;
+            std::map<std::string, std::pair<double, double>> times;
+            std::map<std::string, int> variantFailures;
+
+            for (int type : kernel.types) {
+                for (const auto& input : makeInputs(type, realImages, seed)) {
+                    cv::Mat expected;
+                    double referenceMs = medianTime(kernel.reference.run, input.image, reps, expected);
+                    bool scalarResult = expected.rows == 1 && expected.depth() == CV_64F;
+
+                    for (const auto& variant : kernel.variants) {
+                        cv::Mat actual;
+                        double variantMs = medianTime(variant.run, input.image, reps, actual);
+                        Comparison c = compare(expected, actual);
+                        bool ok = withinTolerance(c, kernel.tolerance, scalarResult);
+
+                        auto& w = worst[variant.name];
+                        w.maxAbsError = std::max(w.maxAbsError, c.maxAbsError);
+                        w.maxRelativeError = std::max(w.maxRelativeError, c.maxRelativeError);
+                        w.psnr = w.psnr == 0.0 ? c.psnr : std::min(w.psnr, c.psnr);
+                        times[variant.name].first += referenceMs;
+                        times[variant.name].second += variantMs;
+
+                        if (!ok) {
+                            variantFailures[variant.name]++;
+                            failures++;
+                        }
+                        if (!ok || verbose) {
+                            std::cout << (ok ? "  ok   " : "  FAIL ") << kernel.name << "/" << variant.name << " "
+                                      << typeName(type) << " " << input.name
+                                      << (c.sizeMismatch ? " size mismatch" : "")
+                                      << " max_abs=" << c.maxAbsError << " max_rel=" << c.maxRelativeError
+                                      << (scalarResult ? "" : " psnr=" + std::to_string(c.psnr)) << "\n";
+                        }
+                    }
+                }
+            }
+
+            for (const auto& variant : kernel.variants) {
+                const auto& w = worst[variant.name];
+                const auto& t = times[variant.name];
+                std::cout << (variantFailures[variant.name] ? "FAIL " : "PASS ") << kernel.name << "/" << variant.name
+                          << " vs " << kernel.reference.name
+                          << ": worst max_abs " << w.maxAbsError << ", worst max_rel " << w.maxRelativeError
+                          << ", worst psnr " << w.psnr
+                          << ", speedup " << (t.second > 0.0 ? t.first / t.second : 0.0) << "x\n";
+            }
+        }
+
+        std::cout << (failures ? std::to_string(failures) + " comparison(s) out of tolerance\n"
+                               : "All variants within tolerance\n");
+        return failures ? 1 : 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in equivalence harness: " << e.what() << "\n";
+        return 1;
+    }
+}
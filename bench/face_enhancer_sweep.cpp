@@ -0,0 +1,426 @@
+#include "batch_journal.h"
+#include "enhancement_algorithms.h"
+#include "face_enhancer.h"
+#include "image_processor.h"
+#include "ssim_engine.h"
+#include "utils.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Synthetic degraded-face corpus and quality-vs-time sweep.
+ *
+ * generate: turns clean face images into reproducible degraded variants
+ * (defocus, motion blur at a random angle, sensor noise, JPEG artifacts),
+ * keeping the clean image as ground truth and recording every degradation
+ * in corpus.tsv.
+ *
+ * sweep: runs the pipeline over a grid of EnhancementParams on that corpus
+ * and reports mean SSIM gain over the degraded input against milliseconds
+ * per image, marking the Pareto-optimal settings. Results go to CSV, and
+ * optionally to an SVG scatter plot.
+ */
+
+namespace {
+    namespace fs = std::filesystem;
+
+    struct Degradation {
+        double defocusSigma = 0.0;  // 0 = no defocus
+        int motionLength = 0;       // 0 = no motion blur
+        double motionAngle = 0.0;   // degrees
+        double noiseSigma = 0.0;
+        int jpegQuality = 100;
+    };
+
+    struct CorpusPair {
+        std::string degradedPath;
+        std::string groundTruthPath;
+        cv::Mat degraded;
+        cv::Mat groundTruth;
+        double baselineSsim = 0.0;  // degraded against ground truth
+    };
+
+    struct SweepPoint {
+        std::vector<std::pair<std::string, std::string>> settings;
+        double meanSsim = 0.0;
+        double meanGain = 0.0;
+        double meanMs = 0.0;
+        double p95Ms = 0.0;
+        size_t failures = 0;
+        bool pareto = false;
+
+        std::string label() const {
+            std::string text;
+            for (const auto& s : settings) {
+                text += (text.empty() ? "" : " ") + s.first + "=" + s.second;
+            }
+            return text;
+        }
+    };
+
+    const char* kManifestName = "corpus.tsv";
+
+    Degradation drawDegradation(cv::RNG& rng) {
+        Degradation d;
+        if (rng.uniform(0.0, 1.0) < 0.6) d.defocusSigma = rng.uniform(0.8, 3.0);
+        if (rng.uniform(0.0, 1.0) < 0.6) {
+            d.motionLength = rng.uniform(2, 11) * 2 + 1;  // odd, 5..21
+            d.motionAngle = rng.uniform(0.0, 180.0);
+        }
+        d.noiseSigma = rng.uniform(1.0, 12.0);
+        d.jpegQuality = rng.uniform(25, 86);
+        return d;
+    }
+
+    cv::Mat degrade(const cv::Mat& clean, const Degradation& d, cv::RNG& rng) {
+        cv::Mat image = clean.clone();
+
+        if (d.defocusSigma > 0.0) {
+            int size = static_cast<int>(std::ceil(d.defocusSigma * 3.0)) * 2 + 1;
+            cv::Mat kernel = EnhancementAlgorithms::createGaussianKernel(size, d.defocusSigma);
+            cv::filter2D(image, image, -1, kernel, cv::Point(-1, -1), 0, cv::BORDER_REFLECT);
+        }
+
+        if (d.motionLength > 0) {
+            cv::Mat kernel = EnhancementAlgorithms::createMotionBlurKernel(d.motionLength, d.motionAngle);
+            kernel /= std::max(cv::sum(kernel)[0], 1.0);
+            cv::filter2D(image, image, -1, kernel, cv::Point(-1, -1), 0, cv::BORDER_REFLECT);
+        }
+
+        if (d.noiseSigma > 0.0) {
+            cv::Mat noise(image.size(), CV_32FC(image.channels()));
+            rng.fill(noise, cv::RNG::NORMAL, 0.0, d.noiseSigma);
+            cv::Mat noisy;
+            image.convertTo(noisy, CV_32F);
+            noisy += noise;
+            noisy.convertTo(image, CV_8U);
+        }
+
+        if (d.jpegQuality < 100) {
+            std::vector<uchar> encoded;
+            cv::imencode(".jpg", image, encoded, {cv::IMWRITE_JPEG_QUALITY, d.jpegQuality});
+            image = cv::imdecode(encoded, cv::IMREAD_COLOR);
+        }
+        return image;
+    }
+
+    int generate(const std::string& inputDir, const std::string& corpusDir, int variants, uint64_t seed) {
+        std::vector<std::string> files = ImageProcessor::getImagesInDirectory(inputDir);
+        if (files.empty()) {
+            Utils::logError("No clean images found in ", inputDir);
+            return 1;
+        }
+
+        fs::create_directories(fs::path(corpusDir) / "ground_truth");
+        fs::create_directories(fs::path(corpusDir) / "degraded");
+        std::ofstream manifest(fs::path(corpusDir) / kManifestName);
+        if (!manifest.is_open()) {
+            Utils::logError("Could not write corpus manifest in ", corpusDir);
+            return 1;
+        }
+        manifest << "# degraded\tground_truth\tdefocus_sigma\tmotion_length\tmotion_angle\tnoise_sigma\tjpeg_quality\n";
+        manifest << std::setprecision(6);
+
+        size_t written = 0;
+        for (const auto& file : files) {
+            cv::Mat clean = ImageProcessor::loadImage(file);
+            if (clean.empty()) continue;
+
+            std::string stem = fs::path(file).stem().string();
+            std::string truthName = "ground_truth/" + stem + ".png";
+            ImageProcessor::saveImage(clean, (fs::path(corpusDir) / truthName).string());
+
+            // Seeded per image name, so adding images never changes existing variants
+            uint64_t imageSeed = BatchJournal::hashBytes(stem.data(), stem.size(), seed);
+            for (int v = 0; v < variants; ++v) {
+                cv::RNG rng(imageSeed + static_cast<uint64_t>(v));
+                Degradation d = drawDegradation(rng);
+                cv::Mat degraded = degrade(clean, d, rng);
+
+                // PNG keeps the JPEG artifacts exactly as generated
+                std::string degradedName = "degraded/" + stem + "_v" + std::to_string(v) + ".png";
+                ImageProcessor::saveImage(degraded, (fs::path(corpusDir) / degradedName).string());
+
+                manifest << degradedName << '\t' << truthName << '\t' << d.defocusSigma << '\t' << d.motionLength
+                         << '\t' << d.motionAngle << '\t' << d.noiseSigma << '\t' << d.jpegQuality << '\n';
+                written++;
+            }
+        }
+
+        Utils::logInfo("Wrote ", written, " degraded variants of ", files.size(), " images to ", corpusDir);
+        return 0;
+    }
+
+    std::vector<CorpusPair> loadCorpus(const std::string& corpusDir, size_t limit) {
+        std::vector<CorpusPair> pairs;
+        std::ifstream manifest(fs::path(corpusDir) / kManifestName);
+        if (!manifest.is_open()) {
+            Utils::logError("No ", kManifestName, " in ", corpusDir);
+            return pairs;
+        }
+
+        std::string line;
+        while (std::getline(manifest, line) && (limit == 0 || pairs.size() < limit)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::vector<std::string> fields = Utils::split(line, '\t');
+            if (fields.size() < 2) continue;
+
+            CorpusPair pair;
+            pair.degradedPath = (fs::path(corpusDir) / fields[0]).string();
+            pair.groundTruthPath = (fs::path(corpusDir) / fields[1]).string();
+            pair.degraded = ImageProcessor::loadImage(pair.degradedPath);
+            pair.groundTruth = ImageProcessor::loadImage(pair.groundTruthPath);
+            if (pair.degraded.empty() || pair.groundTruth.empty()) continue;
+
+            pair.baselineSsim = SSIMEngine::ssim(pair.degraded, pair.groundTruth);
+            pairs.push_back(std::move(pair));
+        }
+        return pairs;
+    }
+
+    // "sharpen=0.5,1,2;denoise=0,10" -> every combination, in grid order
+    std::vector<std::vector<std::pair<std::string, std::string>>> expandGrid(const std::string& spec) {
+        std::vector<std::vector<std::pair<std::string, std::string>>> points(1);
+        for (const auto& axis : Utils::split(spec, ';')) {
+            size_t equals = axis.find('=');
+            if (equals == std::string::npos) continue;
+            std::string key = Utils::trim(axis.substr(0, equals));
+
+            std::vector<std::vector<std::pair<std::string, std::string>>> expanded;
+            for (const auto& point : points) {
+                for (const auto& value : Utils::split(axis.substr(equals + 1), ',')) {
+                    auto next = point;
+                    next.emplace_back(key, Utils::trim(value));
+                    expanded.push_back(std::move(next));
+                }
+            }
+            points = std::move(expanded);
+        }
+        return points;
+    }
+
+    void markPareto(std::vector<SweepPoint>& points) {
+        std::vector<SweepPoint*> order;
+        for (auto& p : points) order.push_back(&p);
+        std::sort(order.begin(), order.end(), [](const SweepPoint* a, const SweepPoint* b) {
+            return a->meanMs < b->meanMs || (a->meanMs == b->meanMs && a->meanGain > b->meanGain);
+        });
+
+        // Faster-first: a point is optimal when nothing quicker gains as much
+        double bestGain = -1e9;
+        for (auto* p : order) {
+            if (p->meanGain > bestGain) {
+                p->pareto = true;
+                bestGain = p->meanGain;
+            }
+        }
+    }
+
+    bool writeSvg(const std::string& path, const std::vector<SweepPoint>& points) {
+        std::ofstream svg(path);
+        if (!svg.is_open()) return false;
+
+        const double width = 800, height = 500, margin = 60;
+        double maxMs = 1e-9, minGain = 0.0, maxGain = 1e-9;
+        for (const auto& p : points) {
+            maxMs = std::max(maxMs, p.meanMs);
+            minGain = std::min(minGain, p.meanGain);
+            maxGain = std::max(maxGain, p.meanGain);
+        }
+        auto x = [&](double ms) { return margin + ms / maxMs * (width - 2 * margin); };
+        auto y = [&](double gain) { return height - margin - (gain - minGain) / (maxGain - minGain) * (height - 2 * margin); };
+
+        svg << std::setprecision(6);
+        svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height << "\">\n";
+        svg << "<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n";
+        svg << "<line x1=\"" << margin << "\" y1=\"" << height - margin << "\" x2=\"" << width - margin
+            << "\" y2=\"" << height - margin << "\" stroke=\"black\"/>\n";
+        svg << "<line x1=\"" << margin << "\" y1=\"" << margin << "\" x2=\"" << margin
+            << "\" y2=\"" << height - margin << "\" stroke=\"black\"/>\n";
+        svg << "<text x=\"" << width / 2 << "\" y=\"" << height - 20 << "\" text-anchor=\"middle\">ms per image (max "
+            << maxMs << ")</text>\n";
+        svg << "<text x=\"20\" y=\"" << height / 2 << "\" transform=\"rotate(-90 20 " << height / 2
+            << ")\" text-anchor=\"middle\">SSIM gain (" << minGain << " to " << maxGain << ")</text>\n";
+
+        std::vector<const SweepPoint*> front;
+        for (const auto& p : points) {
+            if (p.pareto) front.push_back(&p);
+        }
+        std::sort(front.begin(), front.end(), [](const SweepPoint* a, const SweepPoint* b) { return a->meanMs < b->meanMs; });
+        svg << "<polyline fill=\"none\" stroke=\"red\" points=\"";
+        for (const auto* p : front) svg << x(p->meanMs) << "," << y(p->meanGain) << " ";
+        svg << "\"/>\n";
+
+        for (const auto& p : points) {
+            svg << "<circle cx=\"" << x(p.meanMs) << "\" cy=\"" << y(p.meanGain) << "\" r=\"4\" fill=\""
+                << (p.pareto ? "red" : "gray") << "\"><title>" << p.label() << "</title></circle>\n";
+            if (p.pareto) {
+                svg << "<text x=\"" << x(p.meanMs) + 6 << "\" y=\"" << y(p.meanGain) - 6
+                    << "\" font-size=\"10\">" << p.label() << "</text>\n";
+            }
+        }
+        svg << "</svg>\n";
+        return svg.good();
+    }
+
+    int sweep(const std::string& corpusDir, const std::string& gridSpec, const std::string& outputPath,
+              const std::string& plotPath, size_t limit) {
+        std::vector<CorpusPair> corpus = loadCorpus(corpusDir, limit);
+        if (corpus.empty()) {
+            Utils::logError("Corpus is empty: ", corpusDir);
+            return 1;
+        }
+
+        auto grid = expandGrid(gridSpec);
+        Utils::logInfo("Sweeping ", grid.size(), " settings over ", corpus.size(), " images");
+
+        FaceEnhancer enhancer;
+        std::vector<SweepPoint> points;
+        for (const auto& settings : grid) {
+            // Ground truth has the degraded image's size, so super resolution is off unless swept
+            FaceEnhancer::EnhancementParams params;
+            params.srScale = 1;
+            SweepPoint point;
+            point.settings = settings;
+            bool valid = true;
+            for (const auto& s : settings) {
+                if (!FaceEnhancer::applyParamOverride(params, s.first, s.second)) {
+                    Utils::logError("Invalid grid setting: ", s.first, "=", s.second);
+                    valid = false;
+                }
+            }
+            if (!valid) return 1;
+            enhancer.setEnhancementParams(params);
+
+            // Per-image pipeline logging would dominate the timings
+            Utils::setLogLevel(Utils::LOG_WARNING);
+            cv::Mat warmup;
+            enhancer.enhanceImage(corpus.front().degraded, warmup);
+
+            std::vector<double> times, ssims, gains;
+            for (const auto& pair : corpus) {
+                cv::Mat enhanced;
+                auto start = std::chrono::high_resolution_clock::now();
+                bool ok = enhancer.enhanceImage(pair.degraded, enhanced);
+                times.push_back(Utils::getElapsedTime(start));
+                if (!ok) {
+                    point.failures++;
+                    continue;
+                }
+
+                cv::Mat reference, result;
+                ImageProcessor::alignForComparison(pair.groundTruth, enhanced, reference, result);
+                double ssim = SSIMEngine::ssim(result, reference);
+                ssims.push_back(ssim);
+                gains.push_back(ssim - pair.baselineSsim);
+            }
+            Utils::setLogLevel(Utils::LOG_INFO);
+
+            Utils::SampleStats timeStats = Utils::SampleStats::of(times);
+            point.meanMs = timeStats.mean;
+            point.p95Ms = timeStats.p95;
+            point.meanSsim = Utils::SampleStats::of(ssims).mean;
+            point.meanGain = Utils::SampleStats::of(gains).mean;
+            points.push_back(point);
+
+            Utils::logInfo(point.label(), ": SSIM gain ", point.meanGain, ", ", point.meanMs, " ms/image");
+        }
+
+        markPareto(points);
+
+        std::ofstream csv(outputPath);
+        if (!csv.is_open()) {
+            Utils::logError("Could not write sweep results: ", outputPath);
+            return 1;
+        }
+        csv << std::setprecision(8);
+        csv << "settings,mean_ssim,mean_ssim_gain,mean_ms,p95_ms,failures,pareto\n";
+        for (const auto& p : points) {
+            csv << '"' << p.label() << "\"," << p.meanSsim << ',' << p.meanGain << ',' << p.meanMs << ','
+                << p.p95Ms << ',' << p.failures << ',' << (p.pareto ? 1 : 0) << '\n';
+        }
+        Utils::logInfo("Sweep results written to ", outputPath);
+
+        if (!plotPath.empty()) {
+            if (!writeSvg(plotPath, points)) {
+                Utils::logError("Could not write sweep plot: ", plotPath);
+                return 1;
+            }
+            Utils::logInfo("Pareto plot written to ", plotPath);
+        }
+
+        Utils::logInfo("Pareto-optimal settings:");
+        for (const auto& p : points) {
+            if (p.pareto) {
+                Utils::logInfo("  ", p.label(), " (", p.meanGain, " SSIM gain, ", p.meanMs, " ms)");
+            }
+        }
+        return 0;
+    }
+
+    void printUsage(const std::string& programName) {
+        std::cout << "Usage:\n";
+        std::cout << "  " << programName << " generate --input CLEAN_DIR --output CORPUS_DIR [--variants N] [--seed N]\n";
+        std::cout << "  " << programName << " sweep --corpus CORPUS_DIR [--grid SPEC] [--output FILE.csv]"
+                                           " [--plot FILE.svg] [--limit N]\n\n";
+        std::cout << "  --variants N   Degraded variants per clean image (default: 4)\n";
+        std::cout << "  --seed N       Corpus seed (default: 1)\n";
+        std::cout << "  --grid SPEC    key=v1,v2;key=v1,... using the manifest override keys\n";
+        std::cout << "                 (default: sharpen=0.5,1,1.5,2;denoise=0,5,10,15)\n";
+        std::cout << "  --limit N      Use only the first N corpus images\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        if (argc < 2 || std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help") {
+            printUsage(argv[0]);
+            return argc < 2 ? 1 : 0;
+        }
+
+        std::string command = argv[1];
+        std::string input, output, corpus, plot;
+        std::string grid = "sharpen=0.5,1,1.5,2;denoise=0,5,10,15";
+        int variants = 4;
+        uint64_t seed = 1;
+        size_t limit = 0;
+
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--input" && i + 1 < argc) input = argv[++i];
+            else if (arg == "--output" && i + 1 < argc) output = argv[++i];
+            else if (arg == "--corpus" && i + 1 < argc) corpus = argv[++i];
+            else if (arg == "--plot" && i + 1 < argc) plot = argv[++i];
+            else if (arg == "--grid" && i + 1 < argc) grid = argv[++i];
+            else if (arg == "--variants" && i + 1 < argc) variants = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--seed" && i + 1 < argc) seed = std::stoull(argv[++i]);
+            else if (arg == "--limit" && i + 1 < argc) limit = std::stoul(argv[++i]);
+            else {
+                std::cerr << "Unknown option: " << arg << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        if (command == "generate" && !input.empty() && !output.empty()) {
+            return generate(input, output, variants, seed);
+        }
+        if (command == "sweep" && !corpus.empty()) {
+            return sweep(corpus, grid, output.empty() ? "sweep.csv" : output, plot, limit);
+        }
+
+        printUsage(argv[0]);
+        return 1;
+
+    } catch (const std::exception& e) {
+        Utils::logError("Exception in sweep tool: ", e.what());
+        return 1;
+    }
+}
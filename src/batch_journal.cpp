@@ -0,0 +1,166 @@
+#include "batch_journal.h"
+#include "utils.h"
+#include <filesystem>
+
+namespace {
+    const char* const kJournalHeader = "# face_enhancer batch journal v1";
+}
+
+BatchJournal::BatchJournal(const std::string& path)
+    : path_(path) {
+}
+
+bool BatchJournal::open() {
+    entries_.clear();
+    size_t lineCount = 0;
+
+    std::ifstream in(path_);
+    std::string line;
+    while (in && std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        lineCount++;
+
+        std::vector<std::string> fields = Utils::split(line, '\t');
+        if (fields.size() < 6) {
+            Utils::logWarning("Skipping malformed journal line in ", path_);
+            continue;
+        }
+
+        try {
+            Entry entry;
+            entry.size = std::stoull(fields[1]);
+            entry.mtime = std::stoll(fields[2]);
+            entry.contentHash = std::stoull(fields[3], nullptr, 16);
+            entry.paramsHash = std::stoull(fields[4], nullptr, 16);
+            entry.outputPath = fields[5];
+            entries_[fields[0]] = entry;
+        } catch (const std::exception& e) {
+            Utils::logWarning("Skipping malformed journal line in ", path_, ": ", e.what());
+        }
+    }
+    in.close();
+
+    // Incremental runs keep appending; rewrite once superseded lines dominate
+    if (lineCount > 2 * entries_.size() + 100 && !compact()) {
+        return false;
+    }
+
+    bool existed = Utils::fileExists(path_);
+    out_.open(path_, std::ios::app);
+    if (!out_.is_open()) {
+        Utils::logError("Failed to open batch journal: ", path_);
+        return false;
+    }
+    if (!existed) {
+        out_ << kJournalHeader << "\n";
+        out_.flush();
+    }
+
+    Utils::logInfo("Batch journal ", path_, ": ", entries_.size(), " completed inputs");
+    return true;
+}
+
+bool BatchJournal::isUpToDate(const std::string& inputPath, const std::string& outputPath, uint64_t paramsHash) {
+    auto it = entries_.find(inputPath);
+    if (it == entries_.end()) return false;
+
+    Entry& entry = it->second;
+    if (entry.paramsHash != paramsHash || entry.outputPath != outputPath || !Utils::fileExists(outputPath)) {
+        return false;
+    }
+
+    uintmax_t size = 0;
+    int64_t mtime = 0;
+    if (!statFile(inputPath, size, mtime) || size != entry.size) return false;
+    if (mtime == entry.mtime) return true;
+
+    // Touched but possibly unchanged (copied, restored from backup): compare content
+    uint64_t contentHash = 0;
+    if (!hashFile(inputPath, contentHash) || contentHash != entry.contentHash) return false;
+
+    entry.mtime = mtime;
+    writeEntry(out_, inputPath, entry);
+    out_.flush();
+    return true;
+}
+
+bool BatchJournal::record(const std::string& inputPath, const std::string& outputPath, uint64_t paramsHash,
+                          uint64_t contentHash) {
+    Entry entry;
+    if (!statFile(inputPath, entry.size, entry.mtime)) {
+        Utils::logWarning("Could not journal ", inputPath);
+        return false;
+    }
+    entry.contentHash = contentHash;
+    entry.paramsHash = paramsHash;
+    entry.outputPath = outputPath;
+
+    // Flushed per entry so a crash loses at most the image in flight
+    writeEntry(out_, inputPath, entry);
+    out_.flush();
+    entries_[inputPath] = entry;
+    return static_cast<bool>(out_);
+}
+
+uint64_t BatchJournal::hashBytes(const void* data, size_t length, uint64_t seed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool BatchJournal::hashFile(const std::string& path, uint64_t& hash) {
+    Utils::MappedFile file(path);
+    if (!file.isOpen()) return false;
+
+    hash = hashBytes(file.data(), file.size());
+    return true;
+}
+
+bool BatchJournal::statFile(const std::string& path, uintmax_t& size, int64_t& mtime) {
+    std::error_code error;
+    size = std::filesystem::file_size(path, error);
+    if (error) return false;
+
+    auto writeTime = std::filesystem::last_write_time(path, error);
+    if (error) return false;
+
+    mtime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+    return true;
+}
+
+void BatchJournal::writeEntry(std::ostream& stream, const std::string& inputPath, const Entry& entry) {
+    stream << inputPath << '\t' << entry.size << '\t' << entry.mtime << '\t'
+           << std::hex << entry.contentHash << '\t' << entry.paramsHash << std::dec << '\t'
+           << entry.outputPath << '\n';
+}
+
+bool BatchJournal::compact() {
+    std::string tempPath = path_ + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::trunc);
+        if (!out.is_open()) {
+            Utils::logError("Failed to compact batch journal: ", path_);
+            return false;
+        }
+
+        out << kJournalHeader << "\n";
+        for (const auto& entry : entries_) {
+            writeEntry(out, entry.first, entry.second);
+        }
+        if (!out) return false;
+    }
+
+    // Rename is atomic, so a crash leaves either the old or the compacted journal
+    std::error_code error;
+    std::filesystem::rename(tempPath, path_, error);
+    if (error) {
+        Utils::logError("Failed to replace batch journal: ", error.message());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,194 @@
+#include "batch_source.h"
+#include "tracer.h"
+#include <algorithm>
+#include <fstream>
+
+const std::string BatchSource::kOutputPrefix = "enhanced_";
+
+BatchSource::BatchSource(Mode mode, const std::string& input, const std::string& outputDir,
+                         std::function<bool(const std::string&)> accept, const Options& options)
+    : mode_(mode)
+    , input_(input)
+    , outputDir_(outputDir)
+    , accept_(std::move(accept))
+    , options_(options)
+    , items_(options.queueDepth)
+    , discovered_(0)
+    , rejected_(0) {
+    enumerator_ = std::thread([this]() {
+        Tracer::setThreadName("batch enumerator");
+        try {
+            Tracer::Span traceSpan("Enumerate", "io");
+            if (mode_ == MANIFEST) {
+                enumerateManifest();
+            } else {
+                enumerateDirectory(mode_ == RECURSIVE_DIRECTORY);
+            }
+            flushWindow();
+        } catch (const std::exception& e) {
+            Utils::logError("Exception enumerating batch input ", input_.string(), ": ", e.what());
+        }
+        items_.close();
+    });
+}
+
+BatchSource::~BatchSource() {
+    // Closing first unblocks an enumerator waiting on a full queue
+    items_.close();
+    if (enumerator_.joinable()) enumerator_.join();
+}
+
+bool BatchSource::next(Item& item) {
+    return items_.pop(item);
+}
+
+void BatchSource::enumerateDirectory(bool recursive) {
+    namespace fs = std::filesystem;
+    if (!fs::is_directory(input_)) {
+        Utils::logWarning("Directory does not exist: ", input_.string());
+        return;
+    }
+
+    // Outputs are written while the walk is still running, so they must never be picked up as inputs:
+    // an output tree inside the input is skipped whole, and with -o equal to -i files carrying the
+    // output prefix are skipped
+    std::error_code error;
+    const fs::path outputRoot = fs::weakly_canonical(outputDir_, error);
+    const bool outputIsInput = !error && outputRoot == fs::weakly_canonical(input_, error);
+    auto isOutputTree = [&](const fs::path& directory) {
+        std::error_code canonicalError;
+        return !outputIsInput && fs::weakly_canonical(directory, canonicalError) == outputRoot && !canonicalError;
+    };
+
+    // Entries are queued in iteration order; nothing is collected or sorted up front
+    auto visit = [&](const fs::directory_entry& entry) {
+        std::error_code entryError;
+        if (!entry.is_regular_file(entryError)) return true;
+        std::string filename = entry.path().filename().string();
+        if (outputIsInput && Utils::startsWith(filename, kOutputPrefix)) return true;
+        if (accept_ && !accept_(filename)) return true;
+
+        fs::path relative = entry.path().lexically_relative(input_);
+        Item item;
+        item.inputPath = entry.path().string();
+        item.outputPath = mirroredOutputPath(relative);
+        item.name = relative.generic_string();
+        return enqueue(std::move(item));
+    };
+
+    const auto options = fs::directory_options::skip_permission_denied;
+    if (recursive) {
+        for (auto it = fs::recursive_directory_iterator(input_, options); it != fs::recursive_directory_iterator(); ++it) {
+            std::error_code entryError;
+            if (it->is_directory(entryError)) {
+                if (isOutputTree(it->path())) it.disable_recursion_pending();
+                continue;
+            }
+            if (!visit(*it)) break;
+        }
+    } else {
+        for (const auto& entry : fs::directory_iterator(input_, options)) {
+            if (!visit(entry)) break;
+        }
+    }
+}
+
+void BatchSource::enumerateManifest() {
+    std::ifstream manifest(input_);
+    if (!manifest.is_open()) {
+        Utils::logError("Could not open batch manifest: ", input_.string());
+        return;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(manifest, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (Utils::trim(line).empty() || Utils::trim(line)[0] == '#') continue;
+
+        Item item;
+        if (!parseManifestLine(line, item)) {
+            Utils::logWarning("Skipping manifest line ", lineNumber, ": ", line);
+            continue;
+        }
+
+        if (!enqueue(std::move(item))) break;
+    }
+}
+
+bool BatchSource::enqueue(Item item) {
+    if (options_.probeHeaders) {
+        item.probe = ImageProbe::probe(item.inputPath);
+        if (item.probe.isCorrupt()) {
+            Utils::logWarning("Skipping ", item.name, ": unreadable image header");
+            rejected_++;
+            return true;
+        }
+        if (item.probe.valid && !Utils::isValidImageDimensions(item.probe.orientedSize(), options_.minWidth, options_.minHeight)) {
+            Utils::logWarning("Skipping ", item.name, ": ", item.probe.width, "x", item.probe.height,
+                              " is below the minimum size");
+            rejected_++;
+            return true;
+        }
+    }
+
+    discovered_++;
+    if (!options_.probeHeaders || options_.sortWindow <= 1) {
+        return items_.push(std::move(item));
+    }
+
+    window_.push_back(std::move(item));
+    return window_.size() < options_.sortWindow || flushWindow();
+}
+
+bool BatchSource::flushWindow() {
+    // Largest first: long images start early and small ones fill in behind them
+    std::stable_sort(window_.begin(), window_.end(), [](const Item& a, const Item& b) {
+        return a.probe.pixelCount() > b.probe.pixelCount();
+    });
+
+    bool open = true;
+    for (auto& item : window_) {
+        if (open && !items_.push(std::move(item))) open = false;
+    }
+    window_.clear();
+    return open;
+}
+
+bool BatchSource::parseManifestLine(const std::string& line, Item& item) const {
+    namespace fs = std::filesystem;
+    std::vector<std::string> fields = Utils::split(line, '\t');
+    if (fields.empty() || Utils::trim(fields[0]).empty()) return false;
+
+    fs::path inputPath(Utils::trim(fields[0]));
+    if (inputPath.is_relative()) {
+        inputPath = input_.parent_path() / inputPath;
+    }
+    if (accept_ && !accept_(inputPath.filename().string())) return false;
+
+    item.inputPath = inputPath.string();
+    item.name = Utils::trim(fields[0]);
+
+    std::string output = fields.size() > 1 ? Utils::trim(fields[1]) : "";
+    if (output.empty()) {
+        item.outputPath = mirroredOutputPath(inputPath.filename());
+    } else {
+        fs::path outputPath(output);
+        item.outputPath = (outputPath.is_relative() ? outputDir_ / outputPath : outputPath).string();
+    }
+
+    if (fields.size() > 2) {
+        for (const auto& pair : Utils::split(fields[2], ';')) {
+            size_t equalPos = pair.find('=');
+            if (equalPos == std::string::npos) continue;
+            item.overrides[Utils::trim(pair.substr(0, equalPos))] = Utils::trim(pair.substr(equalPos + 1));
+        }
+    }
+
+    return true;
+}
+
+std::string BatchSource::mirroredOutputPath(const std::filesystem::path& relative) const {
+    return (outputDir_ / relative.parent_path() / (kOutputPrefix + relative.filename().string())).string();
+}
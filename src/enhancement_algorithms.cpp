@@ -29,7 +29,7 @@ cv::Mat EnhancementAlgorithms::unsharpMask(const cv::Mat& image, double strength
         
         return sharpened;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in unsharp mask: " + std::string(e.what()));
+        Utils::logError("Exception in unsharp mask: ", e.what());
         return image.clone();
     }
 }
@@ -51,7 +51,7 @@ cv::Mat EnhancementAlgorithms::laplacianSharpen(const cv::Mat& image, double str
         
         return sharpened;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in Laplacian sharpen: " + std::string(e.what()));
+        Utils::logError("Exception in Laplacian sharpen: ", e.what());
         return image.clone();
     }
 }
@@ -73,7 +73,7 @@ cv::Mat EnhancementAlgorithms::highPassSharpen(const cv::Mat& image, double stre
         
         return sharpened;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in high-pass sharpen: " + std::string(e.what()));
+        Utils::logError("Exception in high-pass sharpen: ", e.what());
         return image.clone();
     }
 }
@@ -86,7 +86,7 @@ cv::Mat EnhancementAlgorithms::bilateralFilter(const cv::Mat& image, int d, doub
         cv::bilateralFilter(image, filtered, d, sigmaColor, sigmaSpace);
         return filtered;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in bilateral filter: " + std::string(e.what()));
+        Utils::logError("Exception in bilateral filter: ", e.what());
         return image.clone();
     }
 }
@@ -105,7 +105,7 @@ cv::Mat EnhancementAlgorithms::nonLocalMeansDenoising(const cv::Mat& image, floa
         
         return denoised;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in non-local means denoising: " + std::string(e.what()));
+        Utils::logError("Exception in non-local means denoising: ", e.what());
         return image.clone();
     }
 }
@@ -118,7 +118,7 @@ cv::Mat EnhancementAlgorithms::guidedFilter(const cv::Mat& image, const cv::Mat&
         cv::ximgproc::guidedFilter(guide.empty() ? image : guide, image, filtered, radius, eps);
         return filtered;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in guided filter: " + std::string(e.what()));
+        Utils::logError("Exception in guided filter: ", e.what());
         return image.clone();
     }
 }
@@ -131,7 +131,7 @@ cv::Mat EnhancementAlgorithms::edgePreservingFilter(const cv::Mat& image, int fl
         cv::edgePreservingFilter(image, filtered, flags, static_cast<float>(sigmaS), static_cast<float>(sigmaR));
         return filtered;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in edge preserving filter: " + std::string(e.what()));
+        Utils::logError("Exception in edge preserving filter: ", e.what());
         return image.clone();
     }
 }
@@ -144,7 +144,7 @@ cv::Mat EnhancementAlgorithms::detailEnhance(const cv::Mat& image, double sigmaS
         cv::detailEnhance(image, enhanced, static_cast<float>(sigmaS), static_cast<float>(sigmaR));
         return enhanced;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in detail enhance: " + std::string(e.what()));
+        Utils::logError("Exception in detail enhance: ", e.what());
         return image.clone();
     }
 }
@@ -157,7 +157,7 @@ cv::Mat EnhancementAlgorithms::pencilSketch(const cv::Mat& image, double sigmaS,
         cv::pencilSketch(image, gray, colorized, static_cast<float>(sigmaS), static_cast<float>(sigmaR), static_cast<float>(shadeFactor));
         return colorized;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in pencil sketch: " + std::string(e.what()));
+        Utils::logError("Exception in pencil sketch: ", e.what());
         return image.clone();
     }
 }
@@ -185,7 +185,7 @@ cv::Mat EnhancementAlgorithms::adaptiveHistogramEqualization(const cv::Mat& imag
         
         return result;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in adaptive histogram equalization: " + std::string(e.what()));
+        Utils::logError("Exception in adaptive histogram equalization: ", e.what());
         return image.clone();
     }
 }
@@ -204,7 +204,7 @@ cv::Mat EnhancementAlgorithms::gammaCorrection(const cv::Mat& image, double gamm
         cv::LUT(image, lookupTable, result);
         return result;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in gamma correction: " + std::string(e.what()));
+        Utils::logError("Exception in gamma correction: ", e.what());
         return image.clone();
     }
 }
@@ -234,7 +234,7 @@ cv::Mat EnhancementAlgorithms::retinexSSR(const cv::Mat& image, double sigma) {
         
         return retinex;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in Retinex SSR: " + std::string(e.what()));
+        Utils::logError("Exception in Retinex SSR: ", e.what());
         return image.clone();
     }
 }
@@ -256,7 +256,7 @@ cv::Mat EnhancementAlgorithms::retinexMSR(const cv::Mat& image, const std::vecto
         
         return result;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in Retinex MSR: " + std::string(e.what()));
+        Utils::logError("Exception in Retinex MSR: ", e.what());
         return image.clone();
     }
 }
@@ -269,7 +269,7 @@ cv::Mat EnhancementAlgorithms::bicubicUpscale(const cv::Mat& image, int scale) {
         cv::resize(image, upscaled, cv::Size(), scale, scale, cv::INTER_CUBIC);
         return upscaled;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in bicubic upscale: " + std::string(e.what()));
+        Utils::logError("Exception in bicubic upscale: ", e.what());
         return image.clone();
     }
 }
@@ -282,7 +282,7 @@ cv::Mat EnhancementAlgorithms::lanczosUpscale(const cv::Mat& image, int scale) {
         cv::resize(image, upscaled, cv::Size(), scale, scale, cv::INTER_LANCZOS4);
         return upscaled;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in Lanczos upscale: " + std::string(e.what()));
+        Utils::logError("Exception in Lanczos upscale: ", e.what());
         return image.clone();
     }
 }
@@ -305,7 +305,7 @@ cv::Mat EnhancementAlgorithms::edgeDirectedInterpolation(const cv::Mat& image, i
         
         return enhanced;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in edge-directed interpolation: " + std::string(e.what()));
+        Utils::logError("Exception in edge-directed interpolation: ", e.what());
         return image.clone();
     }
 }
@@ -315,15 +315,15 @@ cv::Mat EnhancementAlgorithms::skinSmoothing(const cv::Mat& image, const std::ve
 
     try {
         cv::Mat result = image.clone();
-        cv::Mat skinMask = createSkinMask(image);
         
         for (const auto& face : faceRegions) {
             // Ensure face region is within image bounds
             cv::Rect safeFace = face & cv::Rect(0, 0, image.cols, image.rows);
             if (safeFace.area() == 0) continue;
             
+            // Work on views of the face only; the skin mask is never built for the whole frame
             cv::Mat faceROI = result(safeFace);
-            cv::Mat faceMask = skinMask(safeFace);
+            cv::Mat faceMask = createSkinMask(image(safeFace));
             
             // Apply bilateral smoothing to face region
             cv::Mat smoothed = bilateralSkinSmoothing(faceROI, faceMask, 15);
@@ -334,7 +334,7 @@ cv::Mat EnhancementAlgorithms::skinSmoothing(const cv::Mat& image, const std::ve
         
         return result;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in skin smoothing: " + std::string(e.what()));
+        Utils::logError("Exception in skin smoothing: ", e.what());
         return image.clone();
     }
 }
@@ -347,19 +347,58 @@ cv::Mat EnhancementAlgorithms::bilateralSkinSmoothing(const cv::Mat& image, cons
         cv::bilateralFilter(image, smoothed, kernelSize, kernelSize * 2, kernelSize / 2);
         
         if (!mask.empty()) {
-            cv::Mat result;
-            image.copyTo(result);
-            smoothed.copyTo(result, mask);
-            return result;
+            // Restore only the non-skin pixels instead of copying the whole region twice
+            cv::Mat nonSkin;
+            cv::bitwise_not(mask, nonSkin);
+            image.copyTo(smoothed, nonSkin);
         }
         
         return smoothed;
     } catch (const std::exception& e) {
-        Utils::logError("Exception in bilateral skin smoothing: " + std::string(e.what()));
+        Utils::logError("Exception in bilateral skin smoothing: ", e.what());
         return image.clone();
     }
 }
 
+cv::Mat EnhancementAlgorithms::createFeatureMask(const cv::Size& imageSize, const std::vector<std::vector<cv::Point2f>>& faceLandmarks, int margin) {
+    cv::Mat mask = cv::Mat::zeros(imageSize, CV_8U);
+
+    try {
+        for (const auto& landmarks : faceLandmarks) {
+            for (const auto& hull : featureHulls(landmarks)) {
+                cv::fillConvexPoly(mask, hull, cv::Scalar(255));
+            }
+        }
+        
+        if (margin > 0) {
+            cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(2 * margin + 1, 2 * margin + 1));
+            cv::dilate(mask, mask, kernel);
+        }
+    } catch (const std::exception& e) {
+        Utils::logError("Exception creating feature mask: ", e.what());
+    }
+    
+    return mask;
+}
+
+cv::Mat EnhancementAlgorithms::createSmoothOnlyMask(const cv::Size& imageSize, const std::vector<cv::Rect>& faces,
+                                                    const std::vector<std::vector<cv::Point2f>>& faceLandmarks, int margin) {
+    cv::Mat mask = cv::Mat::zeros(imageSize, CV_8U);
+    cv::Rect imageRect(0, 0, imageSize.width, imageSize.height);
+
+    // Faces whose landmarks could not be fitted keep full detail work
+    bool any = false;
+    for (size_t i = 0; i < faces.size() && i < faceLandmarks.size(); ++i) {
+        if (featureHulls(faceLandmarks[i]).empty()) continue;
+        mask(faces[i] & imageRect).setTo(cv::Scalar(255));
+        any = true;
+    }
+    if (!any) return cv::Mat();
+
+    mask.setTo(cv::Scalar(0), createFeatureMask(imageSize, faceLandmarks, margin));
+    return mask;
+}
+
 cv::Mat EnhancementAlgorithms::createSkinMask(const cv::Mat& image) {
     if (image.empty()) return cv::Mat();
 
@@ -380,11 +419,36 @@ cv::Mat EnhancementAlgorithms::createSkinMask(const cv::Mat& image) {
         
         return mask;
     } catch (const std::exception& e) {
-        Utils::logError("Exception creating skin mask: " + std::string(e.what()));
+        Utils::logError("Exception creating skin mask: ", e.what());
         return cv::Mat();
     }
 }
 
+std::vector<std::vector<cv::Point>> EnhancementAlgorithms::featureHulls(const std::vector<cv::Point2f>& landmarks) {
+    // iBUG 68-point layout: brows 17-26, eyes 36-47, mouth 48-67
+    static const std::vector<std::vector<int>> featureIndices = {
+        {17, 18, 19, 20, 21, 36, 37, 38, 39, 40, 41},
+        {22, 23, 24, 25, 26, 42, 43, 44, 45, 46, 47},
+        {48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59}
+    };
+    
+    std::vector<std::vector<cv::Point>> hulls;
+    if (landmarks.size() != 68) return hulls;
+    
+    for (const auto& indices : featureIndices) {
+        std::vector<cv::Point> points;
+        for (int index : indices) {
+            points.push_back(cv::Point(cvRound(landmarks[index].x), cvRound(landmarks[index].y)));
+        }
+        
+        std::vector<cv::Point> hull;
+        cv::convexHull(points, hull);
+        hulls.push_back(hull);
+    }
+    
+    return hulls;
+}
+
 // Additional helper implementations would go here for the more complex algorithms
 // like Wiener deconvolution, Richardson-Lucy, etc. These require more advanced
 // mathematical implementations that would significantly increase the code size.
@@ -1,16 +1,40 @@
 #include "face_detector.h"
+#include "image_processor.h"
+#include "image_stats.h"
+#include "memory_tracker.h"
+#include "tracer.h"
 #include "utils.h"
 #include <opencv2/objdetect.hpp>
 #include <opencv2/imgproc.hpp>
 #include <algorithm>
 #include <numeric>
+#include <queue>
+#include <cmath>
+
+namespace {
+    // The SSD model takes 3-channel BGR; batch blobs also need every image to agree
+    cv::Mat toBGR(const cv::Mat& image) {
+        cv::Mat bgr;
+        if (image.channels() == 1) {
+            cv::cvtColor(image, bgr, cv::COLOR_GRAY2BGR);
+        } else if (image.channels() == 4) {
+            cv::cvtColor(image, bgr, cv::COLOR_BGRA2BGR);
+        } else {
+            bgr = image;
+        }
+        return bgr;
+    }
+}
 
 FaceDetector::FaceDetector() 
     : minFaceSize_(30, 30)
     , maxFaceSize_(300, 300)
+    , dnnBatchSize_(8)
+    , dnnInputSize_(300, 300)
     , haarInitialized_(false)
     , lbpInitialized_(false)
-    , dnnInitialized_(false) {
+    , dnnInitialized_(false)
+    , landmarkInitialized_(false) {
     
     // Try to initialize with default cascades
     initializeHaarCascade();
@@ -30,14 +54,14 @@ bool FaceDetector::initializeHaarCascade(const std::string& cascadePath) {
         
         if (Utils::fileExists(path) && haarCascade_.load(path)) {
             haarInitialized_ = true;
-            Utils::logInfo("Haar cascade loaded successfully from: " + path);
+            Utils::logInfo("Haar cascade loaded successfully from: ", path);
             return true;
         } else {
-            Utils::logWarning("Failed to load Haar cascade from: " + path);
+            Utils::logWarning("Failed to load Haar cascade from: ", path);
             return false;
         }
     } catch (const std::exception& e) {
-        Utils::logError("Exception initializing Haar cascade: " + std::string(e.what()));
+        Utils::logError("Exception initializing Haar cascade: ", e.what());
         return false;
     }
 }
@@ -51,14 +75,14 @@ bool FaceDetector::initializeLBPCascade(const std::string& cascadePath) {
         
         if (Utils::fileExists(path) && lbpCascade_.load(path)) {
             lbpInitialized_ = true;
-            Utils::logInfo("LBP cascade loaded successfully from: " + path);
+            Utils::logInfo("LBP cascade loaded successfully from: ", path);
             return true;
         } else {
-            Utils::logWarning("Failed to load LBP cascade from: " + path);
+            Utils::logWarning("Failed to load LBP cascade from: ", path);
             return false;
         }
     } catch (const std::exception& e) {
-        Utils::logError("Exception initializing LBP cascade: " + std::string(e.what()));
+        Utils::logError("Exception initializing LBP cascade: ", e.what());
         return false;
     }
 }
@@ -79,11 +103,47 @@ bool FaceDetector::initializeDNNDetector(const std::string& modelPath, const std
         Utils::logWarning("DNN face detector not available");
         return false;
     } catch (const std::exception& e) {
-        Utils::logError("Exception initializing DNN detector: " + std::string(e.what()));
+        Utils::logError("Exception initializing DNN detector: ", e.what());
         return false;
     }
 }
 
+bool FaceDetector::initializeLandmarkDetector(const std::string& modelPath) {
+#ifndef HAVE_OPENCV_FACE
+    Utils::logWarning("Landmark detection unavailable: OpenCV was built without the contrib face module (", modelPath, ")");
+    return false;
+#else
+    try {
+        std::string path = modelPath;
+        if (path.empty()) {
+            path = getDefaultCascadePath("lbf");
+        }
+        
+        if (Utils::fileExists(path)) {
+            cv::Ptr<cv::face::Facemark> facemark = cv::face::createFacemarkLBF();
+            facemark->loadModel(path);
+            {
+                std::lock_guard<std::mutex> lock(facemarkMutex_);
+                idleFacemarks_.assign(1, facemark);
+                landmarkModelPath_ = path;
+            }
+            landmarkInitialized_ = true;
+            Utils::logInfo("LBF landmark model loaded successfully from: ", path);
+            return true;
+        }
+        
+        Utils::logWarning("Failed to load LBF landmark model from: ", path);
+        return false;
+    } catch (const std::exception& e) {
+        Utils::logError("Exception initializing landmark detector: ", e.what());
+        std::lock_guard<std::mutex> lock(facemarkMutex_);
+        idleFacemarks_.clear();
+        landmarkInitialized_ = false;
+        return false;
+    }
+#endif
+}
+
 std::vector<cv::Rect> FaceDetector::detectFaces(const cv::Mat& image, DetectionMethod method) {
     switch (method) {
         case CASCADE_CLASSIFIER:
@@ -117,21 +177,27 @@ std::vector<cv::Rect> FaceDetector::detectFacesHaar(const cv::Mat& image, double
         // Enhance contrast for better detection
         cv::equalizeHist(gray, gray);
         
+        // Ask for the final stage weights so NMS can rank hits by confidence
+        std::vector<int> rejectLevels;
+        std::vector<double> levelWeights;
         haarCascade_.detectMultiScale(
             gray, 
             faces,
+            rejectLevels,
+            levelWeights,
             scaleFactor,
             minNeighbors,
             cv::CASCADE_SCALE_IMAGE,
             minFaceSize_,
-            maxFaceSize_
+            maxFaceSize_,
+            true
         );
         
-        Utils::logDebug("Haar detection found " + std::to_string(faces.size()) + " faces");
-        return filterOverlappingRects(faces);
+        Utils::logDebug("Haar detection found ", faces.size(), " faces");
+        return filterOverlappingRects(faces, cascadeConfidences(levelWeights));
         
     } catch (const std::exception& e) {
-        Utils::logError("Exception in Haar face detection: " + std::string(e.what()));
+        Utils::logError("Exception in Haar face detection: ", e.what());
         return {};
     }
 }
@@ -155,21 +221,26 @@ std::vector<cv::Rect> FaceDetector::detectFacesLBP(const cv::Mat& image, double
         // Enhance contrast
         cv::equalizeHist(gray, gray);
         
+        std::vector<int> rejectLevels;
+        std::vector<double> levelWeights;
         lbpCascade_.detectMultiScale(
             gray, 
             faces,
+            rejectLevels,
+            levelWeights,
             scaleFactor,
             minNeighbors,
             cv::CASCADE_SCALE_IMAGE,
             minFaceSize_,
-            maxFaceSize_
+            maxFaceSize_,
+            true
         );
         
-        Utils::logDebug("LBP detection found " + std::to_string(faces.size()) + " faces");
-        return filterOverlappingRects(faces);
+        Utils::logDebug("LBP detection found ", faces.size(), " faces");
+        return filterOverlappingRects(faces, cascadeConfidences(levelWeights));
         
     } catch (const std::exception& e) {
-        Utils::logError("Exception in LBP face detection: " + std::string(e.what()));
+        Utils::logError("Exception in LBP face detection: ", e.what());
         return {};
     }
 }
@@ -188,28 +259,92 @@ std::vector<cv::Rect> FaceDetector::detectFacesDNN(const cv::Mat& image, float c
         return postprocessDNNResults(detections, image.size(), confidenceThreshold);
         
     } catch (const std::exception& e) {
-        Utils::logError("Exception in DNN face detection: " + std::string(e.what()));
+        Utils::logError("Exception in DNN face detection: ", e.what());
         return {};
     }
 }
 
+std::vector<std::vector<cv::Rect>> FaceDetector::detectFacesDNNBatch(const std::vector<cv::Mat>& images, float confidenceThreshold) {
+    std::vector<std::vector<cv::Rect>> results(images.size());
+    if (images.empty()) return results;
+
+    if (!dnnInitialized_) {
+        Utils::logWarning("DNN not initialized");
+        return results;
+    }
+
+    try {
+        const size_t batchSize = static_cast<size_t>(dnnBatchSize_);
+        
+        for (size_t start = 0; start < images.size(); start += batchSize) {
+            size_t end = std::min(images.size(), start + batchSize);
+            
+            std::vector<cv::Mat> batch;
+            std::vector<cv::Size> imageSizes;
+            std::vector<size_t> indices;
+            
+            for (size_t i = start; i < end; ++i) {
+                if (images[i].empty()) continue;
+                batch.push_back(images[i]);
+                imageSizes.push_back(images[i].size());
+                indices.push_back(i);
+            }
+            
+            if (batch.empty()) continue;
+            
+            // One forward pass for the whole batch
+            dnnNet_.setInput(preprocessForDNN(batch));
+            cv::Mat detections = dnnNet_.forward();
+            
+            std::vector<std::vector<cv::Rect>> batchFaces = postprocessDNNResults(detections, imageSizes, confidenceThreshold);
+            for (size_t k = 0; k < indices.size(); ++k) {
+                results[indices[k]] = std::move(batchFaces[k]);
+            }
+        }
+        
+        Utils::logDebug("DNN batch detection processed ", images.size(), " images");
+        
+    } catch (const std::exception& e) {
+        Utils::logError("Exception in batched DNN face detection: ", e.what());
+    }
+    
+    return results;
+}
+
 cv::Mat FaceDetector::extractFaceRegion(const cv::Mat& image, const cv::Rect& faceRect, int padding) {
+    cv::Mat view = faceRegionView(image, faceRect, padding);
+    ImageProcessor::detach(view);
+    return view;
+}
+
+std::vector<cv::Mat> FaceDetector::extractAllFaces(const cv::Mat& image, const std::vector<cv::Rect>& faceRects) {
+    std::vector<cv::Mat> faces = faceRegionViews(image, faceRects);
+    for (auto& face : faces) {
+        ImageProcessor::detach(face);
+    }
+    
+    return faces;
+}
+
+cv::Mat FaceDetector::faceRegionView(const cv::Mat& image, const cv::Rect& faceRect, int padding) {
     if (image.empty()) return cv::Mat();
 
     try {
         cv::Rect expandedRect = expandRect(faceRect, image.size(), padding);
-        return image(expandedRect).clone();
+        if (expandedRect.area() == 0) return cv::Mat();
+        return image(expandedRect);
     } catch (const std::exception& e) {
-        Utils::logError("Exception extracting face region: " + std::string(e.what()));
+        Utils::logError("Exception extracting face region: ", e.what());
         return cv::Mat();
     }
 }
 
-std::vector<cv::Mat> FaceDetector::extractAllFaces(const cv::Mat& image, const std::vector<cv::Rect>& faceRects) {
+std::vector<cv::Mat> FaceDetector::faceRegionViews(const cv::Mat& image, const std::vector<cv::Rect>& faceRects, int padding) {
     std::vector<cv::Mat> faces;
+    faces.reserve(faceRects.size());
     
     for (const auto& rect : faceRects) {
-        cv::Mat face = extractFaceRegion(image, rect);
+        cv::Mat face = faceRegionView(image, rect, padding);
         if (!face.empty()) {
             faces.push_back(face);
         }
@@ -220,94 +355,38 @@ std::vector<cv::Mat> FaceDetector::extractAllFaces(const cv::Mat& image, const s
 
 double FaceDetector::assessFaceQuality(const cv::Mat& faceImage) {
     if (faceImage.empty()) return 0.0;
+    return assessFaceQuality(ImageStats::compute(faceImage));
+}
 
-    try {
-        double sharpness = 0.0;
-        double brightness = 0.0;
-        double contrast = 0.0;
-        
-        // Convert to grayscale for analysis
-        cv::Mat gray;
-        if (faceImage.channels() > 1) {
-            cv::cvtColor(faceImage, gray, cv::COLOR_BGR2GRAY);
-        } else {
-            gray = faceImage.clone();
-        }
-        
-        // Calculate sharpness using Laplacian variance
-        cv::Mat laplacian;
-        cv::Laplacian(gray, laplacian, CV_64F);
-        cv::Scalar mean, stddev;
-        cv::meanStdDev(laplacian, mean, stddev);
-        sharpness = stddev.val[0] * stddev.val[0];
-        
-        // Calculate brightness
-        cv::Scalar meanBrightness = cv::mean(gray);
-        brightness = meanBrightness.val[0];
-        
-        // Calculate contrast
-        cv::meanStdDev(gray, mean, stddev);
-        contrast = stddev.val[0];
-        
-        // Normalize and combine metrics (simple weighted average)
-        double normalizedSharpness = std::min(sharpness / 1000.0, 1.0);
-        double normalizedBrightness = 1.0 - std::abs(brightness - 128.0) / 128.0;
-        double normalizedContrast = std::min(contrast / 64.0, 1.0);
-        
-        return (normalizedSharpness * 0.5 + normalizedBrightness * 0.3 + normalizedContrast * 0.2);
-        
-    } catch (const std::exception& e) {
-        Utils::logError("Exception assessing face quality: " + std::string(e.what()));
-        return 0.0;
-    }
+double FaceDetector::assessFaceQuality(const ImageStats& stats) {
+    if (stats.pixelCount == 0) return 0.0;
+
+    // Normalize and combine metrics (simple weighted average)
+    double normalizedSharpness = std::min(stats.sharpness / 1000.0, 1.0);
+    double normalizedBrightness = 1.0 - std::abs(stats.brightness - 128.0) / 128.0;
+    double normalizedContrast = std::min(stats.contrast / 64.0, 1.0);
+    
+    return (normalizedSharpness * 0.5 + normalizedBrightness * 0.3 + normalizedContrast * 0.2);
 }
 
 bool FaceDetector::isFaceBlurred(const cv::Mat& faceImage, double threshold) {
     if (faceImage.empty()) return true;
+    return isFaceBlurred(ImageStats::compute(faceImage), threshold);
+}
 
-    try {
-        cv::Mat gray, laplacian;
-        
-        if (faceImage.channels() > 1) {
-            cv::cvtColor(faceImage, gray, cv::COLOR_BGR2GRAY);
-        } else {
-            gray = faceImage.clone();
-        }
-        
-        cv::Laplacian(gray, laplacian, CV_64F);
-        cv::Scalar mean, stddev;
-        cv::meanStdDev(laplacian, mean, stddev);
-        
-        double variance = stddev.val[0] * stddev.val[0];
-        return variance < threshold;
-        
-    } catch (const std::exception& e) {
-        Utils::logError("Exception checking if face is blurred: " + std::string(e.what()));
-        return true;
-    }
+bool FaceDetector::isFaceBlurred(const ImageStats& stats, double threshold) {
+    if (stats.pixelCount == 0) return true;
+    return stats.sharpness < threshold;
 }
 
 bool FaceDetector::isFaceWellLit(const cv::Mat& faceImage, double minBrightness, double maxBrightness) {
     if (faceImage.empty()) return false;
+    return isFaceWellLit(ImageStats::compute(faceImage), minBrightness, maxBrightness);
+}
 
-    try {
-        cv::Mat gray;
-        
-        if (faceImage.channels() > 1) {
-            cv::cvtColor(faceImage, gray, cv::COLOR_BGR2GRAY);
-        } else {
-            gray = faceImage.clone();
-        }
-        
-        cv::Scalar meanBrightness = cv::mean(gray);
-        double brightness = meanBrightness.val[0];
-        
-        return brightness >= minBrightness && brightness <= maxBrightness;
-        
-    } catch (const std::exception& e) {
-        Utils::logError("Exception checking face lighting: " + std::string(e.what()));
-        return false;
-    }
+bool FaceDetector::isFaceWellLit(const ImageStats& stats, double minBrightness, double maxBrightness) {
+    if (stats.pixelCount == 0) return false;
+    return stats.brightness >= minBrightness && stats.brightness <= maxBrightness;
 }
 
 cv::Mat FaceDetector::drawFaceBoxes(const cv::Mat& image, const std::vector<cv::Rect>& faces) {
@@ -328,7 +407,7 @@ cv::Mat FaceDetector::drawFaceBoxes(const cv::Mat& image, const std::vector<cv::
         
         return result;
     } catch (const std::exception& e) {
-        Utils::logError("Exception drawing face boxes: " + std::string(e.what()));
+        Utils::logError("Exception drawing face boxes: ", e.what());
         return image.clone();
     }
 }
@@ -345,45 +424,134 @@ cv::Mat FaceDetector::drawFaceLandmarks(const cv::Mat& image, const std::vector<
         
         return result;
     } catch (const std::exception& e) {
-        Utils::logError("Exception drawing landmarks: " + std::string(e.what()));
+        Utils::logError("Exception drawing landmarks: ", e.what());
         return image.clone();
     }
 }
 
+void FaceDetector::setDNNBatchSize(int batchSize) {
+    batchSize = std::max(1, batchSize);
+    if (batchSize != dnnBatchSize_) {
+        dnnBatchSize_ = batchSize;
+        dnnBlob_.release();
+    }
+}
+
 // Private helper methods
 
-std::vector<cv::Rect> FaceDetector::filterOverlappingRects(const std::vector<cv::Rect>& rects, double overlapThreshold) {
+std::vector<cv::Rect> FaceDetector::filterOverlappingRects(const std::vector<cv::Rect>& rects) {
+    // Equal scores keep the detection order as the tie-break
+    return filterOverlappingRects(rects, std::vector<float>(rects.size(), 1.0f));
+}
+
+std::vector<cv::Rect> FaceDetector::filterOverlappingRects(const std::vector<cv::Rect>& rects, const std::vector<float>& scores) {
     if (rects.empty()) return {};
+    if (scores.size() != rects.size()) return filterOverlappingRects(rects);
 
     try {
+        const int count = static_cast<int>(rects.size());
+        
+        // Uniform grid sized to the mean box, each box registered in every cell it covers
+        cv::Rect bounds = rects[0];
+        double meanSide = 0.0;
+        for (const auto& rect : rects) {
+            bounds |= rect;
+            meanSide += std::max(rect.width, rect.height);
+        }
+        const int cellSize = std::max(1, static_cast<int>(meanSide / count));
+        const int gridCols = bounds.width / cellSize + 1;
+        const int gridRows = bounds.height / cellSize + 1;
+        std::vector<std::vector<int>> grid(static_cast<size_t>(gridCols) * gridRows);
+        
+        auto cellRange = [&](const cv::Rect& rect, int& c0, int& r0, int& c1, int& r1) {
+            c0 = (rect.x - bounds.x) / cellSize;
+            r0 = (rect.y - bounds.y) / cellSize;
+            c1 = std::min(gridCols - 1, (rect.x + rect.width - 1 - bounds.x) / cellSize);
+            r1 = std::min(gridRows - 1, (rect.y + rect.height - 1 - bounds.y) / cellSize);
+        };
+        
+        for (int i = 0; i < count; ++i) {
+            int c0, r0, c1, r1;
+            cellRange(rects[i], c0, r0, c1, r1);
+            for (int r = r0; r <= r1; ++r) {
+                for (int c = c0; c <= c1; ++c) {
+                    grid[r * gridCols + c].push_back(i);
+                }
+            }
+        }
+        
+        auto overlap = [&](const cv::Rect& a, const cv::Rect& b) {
+            double intersection = (a & b).area();
+            if (intersection <= 0.0) return 0.0;
+            double denominator = nmsParams_.metric == OVERLAP_IOU
+                ? a.area() + b.area() - intersection
+                : std::min(a.area(), b.area());
+            return denominator > 0.0 ? intersection / denominator : 0.0;
+        };
+        
+        // Highest score first, earlier detection first on ties; soft-NMS re-queues
+        // decayed boxes, so stale heap entries are skipped when their score changed
+        std::vector<float> current(scores);
+        auto lowerPriority = [](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+            return a.first < b.first || (a.first == b.first && a.second > b.second);
+        };
+        std::priority_queue<std::pair<float, int>, std::vector<std::pair<float, int>>, decltype(lowerPriority)> queue(lowerPriority);
+        for (int i = 0; i < count; ++i) {
+            queue.emplace(current[i], i);
+        }
+        
+        std::vector<bool> done(count, false);
+        std::vector<int> visitedBy(count, -1);
         std::vector<cv::Rect> filtered;
-        std::vector<bool> suppressed(rects.size(), false);
         
-        for (size_t i = 0; i < rects.size(); ++i) {
-            if (suppressed[i]) continue;
+        while (!queue.empty()) {
+            auto [score, i] = queue.top();
+            queue.pop();
+            if (done[i] || score != current[i]) continue;
+            done[i] = true;
             
+            if (nmsParams_.softNMS && current[i] < nmsParams_.minScore * scores[i]) continue;
             filtered.push_back(rects[i]);
             
-            for (size_t j = i + 1; j < rects.size(); ++j) {
-                if (suppressed[j]) continue;
-                
-                cv::Rect intersection = rects[i] & rects[j];
-                double overlap = static_cast<double>(intersection.area()) / 
-                               std::min(rects[i].area(), rects[j].area());
-                
-                if (overlap > overlapThreshold) {
-                    suppressed[j] = true;
+            int c0, r0, c1, r1;
+            cellRange(rects[i], c0, r0, c1, r1);
+            for (int r = r0; r <= r1; ++r) {
+                for (int c = c0; c <= c1; ++c) {
+                    for (int j : grid[r * gridCols + c]) {
+                        if (done[j] || visitedBy[j] == i) continue;
+                        visitedBy[j] = i;
+                        
+                        double ov = overlap(rects[i], rects[j]);
+                        if (nmsParams_.softNMS) {
+                            if (ov > 0.0) {
+                                current[j] *= static_cast<float>(std::exp(-(ov * ov) / nmsParams_.softSigma));
+                                queue.emplace(current[j], j);
+                            }
+                        } else if (ov > nmsParams_.overlapThreshold) {
+                            done[j] = true;
+                        }
+                    }
                 }
             }
         }
         
         return filtered;
     } catch (const std::exception& e) {
-        Utils::logError("Exception filtering overlapping rectangles: " + std::string(e.what()));
+        Utils::logError("Exception filtering overlapping rectangles: ", e.what());
         return rects;
     }
 }
 
+std::vector<float> FaceDetector::cascadeConfidences(const std::vector<double>& levelWeights) {
+    // Map the final stage margin into (0, 1) so soft-NMS decay stays monotonic
+    std::vector<float> confidences;
+    confidences.reserve(levelWeights.size());
+    for (double weight : levelWeights) {
+        confidences.push_back(static_cast<float>(1.0 / (1.0 + std::exp(-weight))));
+    }
+    return confidences;
+}
+
 cv::Rect FaceDetector::expandRect(const cv::Rect& rect, const cv::Size& imageSize, int padding) {
     cv::Rect expanded(
         std::max(0, rect.x - padding),
@@ -412,6 +580,12 @@ std::string FaceDetector::getDefaultCascadePath(const std::string& cascadeType)
             "../../data/lbpcascades/lbpcascade_frontalface.xml",
             cv::samples::findFile("lbpcascade_frontalface.xml")
         };
+    } else if (cascadeType == "lbf") {
+        searchPaths = {
+            "data/lbfmodel.yaml",
+            "../data/lbfmodel.yaml",
+            "../../data/lbfmodel.yaml"
+        };
     }
     
     for (const auto& path : searchPaths) {
@@ -425,20 +599,48 @@ std::string FaceDetector::getDefaultCascadePath(const std::string& cascadeType)
 
 cv::Mat FaceDetector::preprocessForDNN(const cv::Mat& image, const cv::Size& inputSize) {
     cv::Mat blob;
-    cv::dnn::blobFromImage(image, blob, 1.0, inputSize, cv::Scalar(104, 117, 123), false, false);
+    cv::dnn::blobFromImage(toBGR(image), blob, 1.0, inputSize, cv::Scalar(104, 117, 123), false, false);
+    return blob;
+}
+
+cv::Mat FaceDetector::preprocessForDNN(const std::vector<cv::Mat>& images) {
+    const int channels = 3;
+    std::vector<cv::Mat> bgrImages;
+    bgrImages.reserve(images.size());
+    for (const auto& image : images) {
+        bgrImages.push_back(toBGR(image));
+    }
+    
+    // Allocate the blob for a full batch once; later batches write into the same buffer
+    if (dnnBlob_.dims != 4 || dnnBlob_.size[0] != dnnBatchSize_) {
+        const int fullShape[] = { dnnBatchSize_, channels, dnnInputSize_.height, dnnInputSize_.width };
+        dnnBlob_.create(4, fullShape, CV_32F);
+    }
+    
+    // A short final batch uses a header over the leading images of the buffer
+    const int shape[] = { static_cast<int>(images.size()), channels, dnnInputSize_.height, dnnInputSize_.width };
+    cv::Mat blob(4, shape, CV_32F, dnnBlob_.ptr<float>());
+    cv::dnn::blobFromImages(bgrImages, blob, 1.0, dnnInputSize_, cv::Scalar(104, 117, 123), false, false);
     return blob;
 }
 
 std::vector<cv::Rect> FaceDetector::postprocessDNNResults(const cv::Mat& detections, const cv::Size& imageSize, float confidenceThreshold) {
-    std::vector<cv::Rect> faces;
+    return postprocessDNNResults(detections, std::vector<cv::Size>{imageSize}, confidenceThreshold).front();
+}
+
+std::vector<std::vector<cv::Rect>> FaceDetector::postprocessDNNResults(const cv::Mat& detections, const std::vector<cv::Size>& imageSizes, float confidenceThreshold) {
+    std::vector<std::vector<cv::Rect>> faces(imageSizes.size());
     
     try {
-        cv::Mat detectionMat(detections.size[2], detections.size[3], CV_32F, detections.ptr<float>());
+        // SSD output is [1, 1, N, 7] with rows of (imageId, label, confidence, x1, y1, x2, y2)
+        cv::Mat detectionMat(detections.size[2], detections.size[3], CV_32F, const_cast<float*>(detections.ptr<float>()));
         
         for (int i = 0; i < detectionMat.rows; ++i) {
             float confidence = detectionMat.at<float>(i, 2);
+            int imageId = static_cast<int>(detectionMat.at<float>(i, 0));
             
-            if (confidence > confidenceThreshold) {
+            if (confidence > confidenceThreshold && imageId >= 0 && imageId < static_cast<int>(imageSizes.size())) {
+                const cv::Size& imageSize = imageSizes[imageId];
                 int x1 = static_cast<int>(detectionMat.at<float>(i, 3) * imageSize.width);
                 int y1 = static_cast<int>(detectionMat.at<float>(i, 4) * imageSize.height);
                 int x2 = static_cast<int>(detectionMat.at<float>(i, 5) * imageSize.width);
@@ -450,20 +652,97 @@ std::vector<cv::Rect> FaceDetector::postprocessDNNResults(const cv::Mat& detecti
                 face = face & cv::Rect(0, 0, imageSize.width, imageSize.height);
                 
                 if (face.area() > 0) {
-                    faces.push_back(face);
+                    faces[imageId].push_back(face);
                 }
             }
         }
     } catch (const std::exception& e) {
-        Utils::logError("Exception in DNN postprocessing: " + std::string(e.what()));
+        Utils::logError("Exception in DNN postprocessing: ", e.what());
     }
     
     return faces;
 }
 
 std::vector<cv::Point2f> FaceDetector::detectFaceLandmarks(const cv::Mat& image, const cv::Rect& faceRect) {
-    // This would require a separate landmark detection model
-    // For now, return empty vector
-    Utils::logWarning("Face landmark detection not implemented");
-    return {};
-}
\ No newline at end of file
+    if (!landmarkInitialized_) {
+        Utils::logWarning("Landmark detector not initialized");
+        return {};
+    }
+    
+    return detectAllFaceLandmarks(image, {faceRect}).front();
+}
+
+std::vector<std::vector<cv::Point2f>> FaceDetector::detectAllFaceLandmarks(const cv::Mat& image, const std::vector<cv::Rect>& faceRects) {
+    std::vector<std::vector<cv::Point2f>> landmarks(faceRects.size());
+    if (image.empty() || faceRects.empty() || !landmarkInitialized_) return landmarks;
+
+#ifdef HAVE_OPENCV_FACE
+    try {
+        cv::Mat gray;
+        if (image.channels() > 1) {
+            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+        } else {
+            gray = image;
+        }
+        
+        // Faces are fitted in parallel, each worker on its own Facemark instance
+        const MemoryTracker::Context memoryContext = MemoryTracker::currentContext();
+        const int faceCount = static_cast<int>(faceRects.size());
+        cv::parallel_for_(cv::Range(0, faceCount), [&](const cv::Range& range) {
+            MemoryTracker::ContextScope memoryScope(memoryContext);
+            Tracer::Span traceSpan("Landmark fitting", "opencv");
+            cv::Ptr<cv::face::Facemark> facemark = acquireFacemark();
+            if (!facemark) return;
+            try {
+                for (int i = range.start; i < range.end; ++i) {
+                    std::vector<std::vector<cv::Point2f>> fitted;
+                    if (facemark->fit(gray, std::vector<cv::Rect>{faceRects[i]}, fitted) && !fitted.empty()) {
+                        landmarks[i] = std::move(fitted.front());
+                    }
+                }
+            } catch (const std::exception& e) {
+                Utils::logError("Exception fitting face landmarks: ", e.what());
+            }
+            releaseFacemark(facemark);
+        }, faceCount);
+        
+        Utils::logDebug("Fitted landmarks for ", faceRects.size(), " faces");
+    } catch (const std::exception& e) {
+        Utils::logError("Exception detecting face landmarks: ", e.what());
+    }
+#endif
+    
+    return landmarks;
+}
+
+#ifdef HAVE_OPENCV_FACE
+cv::Ptr<cv::face::Facemark> FaceDetector::acquireFacemark() {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(facemarkMutex_);
+        if (!idleFacemarks_.empty()) {
+            cv::Ptr<cv::face::Facemark> facemark = idleFacemarks_.back();
+            idleFacemarks_.pop_back();
+            return facemark;
+        }
+        path = landmarkModelPath_;
+    }
+    
+    // Every instance is busy: load another copy of the model for this worker
+    try {
+        Tracer::Span traceSpan("Landmark model load", "io");
+        cv::Ptr<cv::face::Facemark> facemark = cv::face::createFacemarkLBF();
+        facemark->loadModel(path);
+        Utils::logDebug("Loaded another LBF landmark instance from: ", path);
+        return facemark;
+    } catch (const std::exception& e) {
+        Utils::logError("Exception loading landmark model: ", e.what());
+        return cv::Ptr<cv::face::Facemark>();
+    }
+}
+
+void FaceDetector::releaseFacemark(const cv::Ptr<cv::face::Facemark>& facemark) {
+    std::lock_guard<std::mutex> lock(facemarkMutex_);
+    idleFacemarks_.push_back(facemark);
+}
+#endif
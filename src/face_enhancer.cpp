@@ -2,13 +2,48 @@
 #include "image_processor.h"
 #include "enhancement_algorithms.h"
 #include "face_detector.h"
+#include "image_stats.h"
+#include "ssim_engine.h"
+#include "face_tracker.h"
+#include "temporal_denoiser.h"
+#include "image_encoder.h"
+#include "batch_source.h"
+#include "batch_journal.h"
+#include "memory_tracker.h"
+#include "tracer.h"
 #include "utils.h"
 #include <iostream>
+#include <cmath>
+#include <sstream>
+#include <istream>
+#include <ostream>
 #include <chrono>
+#include <thread>
+#include <deque>
+#include <future>
+#include <filesystem>
+
+namespace {
+    // Memory tracker stages, registered once during static initialization
+    const MemoryTracker::Stage kPreprocessingStage("Preprocessing");
+    const MemoryTracker::Stage kFaceDetectionStage("Face Detection");
+    const MemoryTracker::Stage kFaceTrackingStage("Face Tracking");
+    const MemoryTracker::Stage kQualityRoutingStage("Quality Routing");
+    const MemoryTracker::Stage kLandmarkDetectionStage("Landmark Detection");
+    const MemoryTracker::Stage kNoiseReductionStage("Noise Reduction");
+    const MemoryTracker::Stage kSharpeningStage("Sharpening");
+    const MemoryTracker::Stage kEdgeEnhancementStage("Edge Enhancement");
+    const MemoryTracker::Stage kBrightnessContrastStage("Brightness/Contrast");
+    const MemoryTracker::Stage kHistogramEnhancementStage("Histogram Enhancement");
+    const MemoryTracker::Stage kSkinSmoothingStage("Skin Smoothing");
+    const MemoryTracker::Stage kSuperResolutionStage("Super Resolution");
+    const MemoryTracker::Stage kPostProcessingStage("Post-processing");
+}
 
 FaceEnhancer::FaceEnhancer() {
     // Initialize default parameters
     params_ = EnhancementParams();
+    faceDetector_ = std::make_unique<FaceDetector>();
     
     // Initialize face detector and super resolution
     if (!initializeFaceDetector()) {
@@ -25,168 +60,883 @@ FaceEnhancer::~FaceEnhancer() {
 }
 
 bool FaceEnhancer::enhanceImage(const std::string& inputPath, const std::string& outputPath) {
+    return enhanceImage(inputPath, outputPath, nullptr);
+}
+
+bool FaceEnhancer::enhanceImage(const std::string& inputPath, const std::string& outputPath, QualityMetrics* metrics) {
+    Tracer::ImageScope traceImage(Tracer::isEnabled() ? Utils::getBasename(inputPath) : std::string());
     try {
-        Utils::logInfo("Loading image: " + inputPath);
-        cv::Mat inputImage = ImageProcessor::loadImage(inputPath);
-        
-        if (inputImage.empty()) {
-            Utils::logError("Failed to load image: " + inputPath);
+        cv::Mat inputImage, outputImage;
+        if (!enhanceFile(inputPath, outputImage, 0, metrics ? &inputImage : nullptr)) {
             return false;
         }
 
-        cv::Mat outputImage;
-        if (!enhanceImage(inputImage, outputImage)) {
-            Utils::logError("Failed to enhance image: " + inputPath);
-            return false;
+        // Metrics read the in-memory images on another thread while this one encodes
+        std::future<QualityMetrics> pendingMetrics;
+        if (metrics) {
+            int proxySide = params_.metricsProxySide;
+            pendingMetrics = std::async(std::launch::async, [inputImage, outputImage, proxySide]() {
+                return computeQualityMetrics(inputImage, outputImage, proxySide);
+            });
         }
 
-        Utils::logInfo("Saving enhanced image: " + outputPath);
-        if (!ImageProcessor::saveImage(outputImage, outputPath)) {
-            Utils::logError("Failed to save image: " + outputPath);
+        Utils::logInfo("Saving enhanced image: ", outputPath);
+        bool saved = false;
+        {
+            Tracer::Span traceSpan("Encode", "io");
+            saved = ImageProcessor::saveImage(outputImage, outputPath, params_.outputQuality, params_.encodePreset);
+        }
+        if (metrics) {
+            *metrics = pendingMetrics.get();
+        }
+        
+        if (!saved) {
+            Utils::logError("Failed to save image: ", outputPath);
             return false;
         }
 
-        Utils::logInfo("Successfully enhanced image: " + inputPath + " -> " + outputPath);
+        Utils::logInfo("Successfully enhanced image: ", inputPath, " -> ", outputPath);
         return true;
 
     } catch (const std::exception& e) {
-        Utils::logError("Exception in enhanceImage: " + std::string(e.what()));
+        Utils::logError("Exception in enhanceImage: ", e.what());
+        return false;
+    }
+}
+
+bool FaceEnhancer::enhanceFile(const std::string& inputPath, cv::Mat& outputImage, int maxInputSide, cv::Mat* loadedInput) {
+    cv::Mat inputImage = loadInput(inputPath, maxInputSide);
+    if (inputImage.empty()) {
+        return false;
+    }
+
+    if (!enhanceDecoded(inputImage, outputImage, KnownFaces())) {
+        Utils::logError("Failed to enhance image: ", inputPath);
         return false;
     }
+    
+    if (loadedInput) {
+        *loadedInput = inputImage;
+    }
+    return true;
+}
+
+cv::Mat FaceEnhancer::loadInput(const std::string& inputPath, int maxInputSide, uint64_t* contentHash) {
+    Utils::logInfo("Loading image: ", inputPath);
+    
+    // With a capped output only enough resolution to cover the cap before super resolution is decoded
+    int decodeSide = 0;
+    if (params_.maxOutputSide > 0) {
+        int scale = std::max(1, params_.srScale);
+        decodeSide = (params_.maxOutputSide + scale - 1) / scale;
+    }
+    if (maxInputSide > 0) {
+        decodeSide = decodeSide > 0 ? std::min(decodeSide, maxInputSide) : maxInputSide;
+    }
+    cv::Mat inputImage;
+    {
+        Tracer::Span traceSpan("Decode", "io");
+        if (contentHash) {
+            Utils::MappedFile file(inputPath);
+            if (file.isOpen()) {
+                *contentHash = BatchJournal::hashBytes(file.data(), file.size());
+                inputImage = ImageProcessor::decodeImage(file.data(), file.size(), inputPath, decodeSide);
+            }
+        } else {
+            inputImage = params_.memoryMappedInput ? ImageProcessor::loadImageMapped(inputPath, decodeSide)
+                                                   : ImageProcessor::loadImage(inputPath, decodeSide);
+        }
+    }
+    
+    if (inputImage.empty()) {
+        Utils::logError("Failed to load image: ", inputPath);
+        return inputImage;
+    }
+    
+    // Formats without reduced decode still arrive full size; shrink them before the pipeline
+    int inputSide = std::max(inputImage.cols, inputImage.rows);
+    if (maxInputSide > 0 && inputSide > maxInputSide) {
+        inputImage = ImageProcessor::resizeImageProportional(inputImage,
+            static_cast<double>(maxInputSide) / inputSide, cv::INTER_AREA);
+    }
+    return inputImage;
+}
+
+bool FaceEnhancer::enhanceDecoded(const cv::Mat& inputImage, cv::Mat& outputImage, const KnownFaces& knownFaces) {
+    if (!runPipeline(inputImage, outputImage, knownFaces)) {
+        return false;
+    }
+    applyOutputCap(outputImage);
+    return true;
+}
+
+FaceEnhancer::QualityMetrics FaceEnhancer::computeQualityMetrics(const cv::Mat& original, const cv::Mat& enhanced, int proxySide) {
+    QualityMetrics metrics;
+    if (original.empty() || enhanced.empty()) return metrics;
+
+    try {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        
+        cv::Mat reference, result;
+        ImageProcessor::alignForComparison(original, enhanced, reference, result, proxySide);
+        
+        metrics.psnr = ImageProcessor::calculatePSNR(reference, result);
+        metrics.ssim = ImageProcessor::calculateSSIM(reference, result);
+        metrics.msssim = SSIMEngine::msssim(reference, result);
+        metrics.sharpnessOriginal = ImageProcessor::calculateSharpness(reference);
+        metrics.sharpnessEnhanced = ImageProcessor::calculateSharpness(result);
+        metrics.evaluatedSize = result.size();
+        metrics.computed = true;
+        metrics.timeMs = Utils::getElapsedTime(startTime);
+        
+    } catch (const std::exception& e) {
+        Utils::logError("Exception computing quality metrics: ", e.what());
+    }
+    
+    return metrics;
+}
+
+void FaceEnhancer::applyOutputCap(cv::Mat& image) const {
+    int outputSide = std::max(image.cols, image.rows);
+    if (params_.maxOutputSide > 0 && outputSide > params_.maxOutputSide) {
+        image = ImageProcessor::resizeImageProportional(image,
+            static_cast<double>(params_.maxOutputSide) / outputSide, cv::INTER_AREA);
+    }
 }
 
 bool FaceEnhancer::enhanceImage(const cv::Mat& inputImage, cv::Mat& outputImage) {
+    return runPipeline(inputImage, outputImage, KnownFaces());
+}
+
+bool FaceEnhancer::runPipeline(const cv::Mat& inputImage, cv::Mat& outputImage, const KnownFaces& knownFaces,
+                               bool preDenoised) {
     if (inputImage.empty()) {
         Utils::logError("Input image is empty");
         return false;
     }
 
     try {
+        Tracer::Span traceSpan("Enhance", "image");
         auto startTime = std::chrono::high_resolution_clock::now();
+        lastStageTimes_.clear();
+        MemoryTracker::beginImage();
         
         Utils::logInfo("Starting image enhancement pipeline");
-        Utils::logInfo("Input image info: " + Utils::getImageInfo(inputImage));
+        if (Utils::isLogEnabled(Utils::LOG_INFO)) {
+            Utils::logInfo("Input image info: ", Utils::getImageInfo(inputImage));
+        }
 
         // Step 1: Preprocess image
-        cv::Mat processedImage = preprocessImage(inputImage);
+        cv::Mat processedImage;
+        {
+            MemoryTracker::StageScope memoryStage(kPreprocessingStage);
+            processedImage = preprocessImage(inputImage);
+        }
         logProcessingStep("Preprocessing", Utils::getElapsedTime(startTime));
 
-        // Step 2: Detect faces for face-specific enhancements
+        // Step 2: Detect faces for face-specific enhancements (unless the caller already has them)
         auto faceStartTime = std::chrono::high_resolution_clock::now();
-        std::vector<cv::Rect> faces = detectFaces(processedImage);
-        logProcessingStep("Face Detection", Utils::getElapsedTime(faceStartTime));
+        const bool tracked = knownFaces.faces && knownFaces.tracked;
+        std::vector<cv::Rect> faces;
+        {
+            MemoryTracker::StageScope memoryStage(tracked ? kFaceTrackingStage : kFaceDetectionStage);
+            faces = knownFaces.faces ? *knownFaces.faces : detectFaces(processedImage);
+        }
+        logProcessingStep(tracked ? "Face Tracking" : "Face Detection", Utils::getElapsedTime(faceStartTime));
+        // The caller's detection already has its own trace span; only the stage total takes this image's share
+        lastStageTimes_.back().second += knownFaces.detectionMs;
         
-        Utils::logInfo("Detected " + std::to_string(faces.size()) + " face(s)");
+        Utils::logInfo("Detected ", faces.size(), " face(s)");
+
+        // Score image and faces cheaply to decide which stages are worth running
+        PipelineRoute route = ROUTE_FULL;
+        lastRouting_ = RoutingDecision();
+        if (params_.adaptiveRouting) {
+            auto routeStartTime = std::chrono::high_resolution_clock::now();
+            MemoryTracker::StageScope memoryStage(kQualityRoutingStage);
+            lastRouting_ = routePipeline(processedImage, faces);
+            route = lastRouting_.route;
+            lastRouting_.timeSavedMs = -Utils::getElapsedTime(routeStartTime);
+            logProcessingStep("Quality Routing", -lastRouting_.timeSavedMs);
+        }
+        const double megapixels = processedImage.total() / 1e6;
 
-        // Step 3: Noise reduction
-        auto noiseStartTime = std::chrono::high_resolution_clock::now();
-        processedImage = reduceNoise(processedImage);
-        logProcessingStep("Noise Reduction", Utils::getElapsedTime(noiseStartTime));
+        // Facial landmarks separate the eyes and mouth, which need detail work, from cheeks that only get smoothed
+        cv::Mat smoothOnlyMask;
+        if (route == ROUTE_FULL && !faces.empty() && params_.landmarkGuidedDetail && faceDetector_->hasLandmarkDetector()) {
+            auto landmarkStartTime = std::chrono::high_resolution_clock::now();
+            MemoryTracker::StageScope memoryStage(kLandmarkDetectionStage);
+            std::vector<std::vector<cv::Point2f>> landmarks = faceDetector_->detectAllFaceLandmarks(processedImage, faces);
+            smoothOnlyMask = EnhancementAlgorithms::createSmoothOnlyMask(processedImage.size(), faces, landmarks);
+            logProcessingStep("Landmark Detection", Utils::getElapsedTime(landmarkStartTime));
+        }
+
+        // Step 3: Noise reduction (video frames may already be denoised across time)
+        if (route == ROUTE_FULL && !preDenoised) {
+            auto noiseStartTime = std::chrono::high_resolution_clock::now();
+            MemoryTracker::StageScope memoryStage(kNoiseReductionStage);
+            processedImage = reduceNoise(processedImage);
+            recordStageCost("Noise Reduction", Utils::getElapsedTime(noiseStartTime), megapixels);
+        }
 
         // Step 4: Sharpening
-        auto sharpenStartTime = std::chrono::high_resolution_clock::now();
-        processedImage = sharpenImage(processedImage);
-        logProcessingStep("Sharpening", Utils::getElapsedTime(sharpenStartTime));
+        if (route != ROUTE_SKIP) {
+            auto sharpenStartTime = std::chrono::high_resolution_clock::now();
+            MemoryTracker::StageScope memoryStage(kSharpeningStage);
+            processedImage = smoothOnlyMask.empty() ? sharpenImage(processedImage) : sharpenOutside(processedImage, smoothOnlyMask);
+            recordStageCost("Sharpening", Utils::getElapsedTime(sharpenStartTime), megapixels);
+        }
 
         // Step 5: Edge enhancement
-        auto edgeStartTime = std::chrono::high_resolution_clock::now();
-        processedImage = enhanceEdges(processedImage);
-        logProcessingStep("Edge Enhancement", Utils::getElapsedTime(edgeStartTime));
+        if (route == ROUTE_FULL) {
+            auto edgeStartTime = std::chrono::high_resolution_clock::now();
+            MemoryTracker::StageScope memoryStage(kEdgeEnhancementStage);
+            processedImage = smoothOnlyMask.empty() ? enhanceEdges(processedImage) : enhanceEdgesOutside(processedImage, smoothOnlyMask);
+            recordStageCost("Edge Enhancement", Utils::getElapsedTime(edgeStartTime), megapixels);
+        }
 
         // Step 6: Brightness and contrast adjustment
-        auto contrastStartTime = std::chrono::high_resolution_clock::now();
-        processedImage = adjustBrightnessContrast(processedImage);
-        logProcessingStep("Brightness/Contrast", Utils::getElapsedTime(contrastStartTime));
+        if (route != ROUTE_SKIP) {
+            auto contrastStartTime = std::chrono::high_resolution_clock::now();
+            MemoryTracker::StageScope memoryStage(kBrightnessContrastStage);
+            processedImage = adjustBrightnessContrast(processedImage);
+            recordStageCost("Brightness/Contrast", Utils::getElapsedTime(contrastStartTime), megapixels);
+        }
 
         // Step 7: Histogram enhancement
-        auto histStartTime = std::chrono::high_resolution_clock::now();
-        processedImage = enhanceHistogram(processedImage);
-        logProcessingStep("Histogram Enhancement", Utils::getElapsedTime(histStartTime));
+        if (route != ROUTE_SKIP) {
+            auto histStartTime = std::chrono::high_resolution_clock::now();
+            MemoryTracker::StageScope memoryStage(kHistogramEnhancementStage);
+            processedImage = enhanceHistogram(processedImage);
+            recordStageCost("Histogram Enhancement", Utils::getElapsedTime(histStartTime), megapixels);
+        }
 
         // Step 8: Skin smoothing (if faces detected)
-        if (!faces.empty()) {
+        if (route == ROUTE_FULL && !faces.empty()) {
             auto skinStartTime = std::chrono::high_resolution_clock::now();
+            MemoryTracker::StageScope memoryStage(kSkinSmoothingStage);
             processedImage = smoothSkin(processedImage, faces);
-            logProcessingStep("Skin Smoothing", Utils::getElapsedTime(skinStartTime));
+            recordStageCost("Skin Smoothing", Utils::getElapsedTime(skinStartTime), megapixels);
+        }
+
+        if (params_.adaptiveRouting) {
+            lastRouting_.timeSavedMs += estimateSkippedTime(route, !faces.empty(), megapixels);
+            Utils::logInfo("Route: ", getRouteName(route),
+                           " (image quality ", lastRouting_.imageQuality,
+                           ", min face quality ", lastRouting_.minFaceQuality,
+                           ", est. time saved ", lastRouting_.timeSavedMs, " ms)");
         }
 
         // Step 9: Super resolution (optional)
         if (params_.srScale > 1) {
             auto srStartTime = std::chrono::high_resolution_clock::now();
+            MemoryTracker::StageScope memoryStage(kSuperResolutionStage);
             processedImage = superResolution(processedImage);
             logProcessingStep("Super Resolution", Utils::getElapsedTime(srStartTime));
         }
 
         // Step 10: Post-processing
         auto postStartTime = std::chrono::high_resolution_clock::now();
-        outputImage = postprocessImage(processedImage);
+        {
+            MemoryTracker::StageScope memoryStage(kPostProcessingStage);
+            outputImage = postprocessImage(processedImage);
+        }
         logProcessingStep("Post-processing", Utils::getElapsedTime(postStartTime));
 
         double totalTime = Utils::getElapsedTime(startTime);
-        Utils::logInfo("Total enhancement time: " + std::to_string(totalTime) + " ms");
-        Utils::logInfo("Output image info: " + Utils::getImageInfo(outputImage));
+        Utils::logInfo("Total enhancement time: ", totalTime, " ms");
+        lastPeakMatBytes_ = MemoryTracker::getImagePeakBytes();
+        if (MemoryTracker::isInstalled()) {
+            Utils::logDebug("Peak Mat memory: ", Utils::formatFileSize(lastPeakMatBytes_));
+        }
+        if (Utils::isLogEnabled(Utils::LOG_INFO)) {
+            Utils::logInfo("Output image info: ", Utils::getImageInfo(outputImage));
+        }
 
         return true;
 
     } catch (const std::exception& e) {
-        Utils::logError("Exception in image enhancement pipeline: " + std::string(e.what()));
+        Utils::logError("Exception in image enhancement pipeline: ", e.what());
         return false;
     }
 }
 
 bool FaceEnhancer::enhanceBatch(const std::string& inputDir, const std::string& outputDir) {
+    BatchSource source(params_.recursiveBatch ? BatchSource::RECURSIVE_DIRECTORY : BatchSource::FLAT_DIRECTORY,
+                       inputDir, outputDir, [this](const std::string& file) { return isValidImageFormat(file); },
+                       getBatchSourceOptions());
+    return runBatch(source, inputDir, outputDir);
+}
+
+bool FaceEnhancer::enhanceManifest(const std::string& manifestPath, const std::string& outputDir) {
+    BatchSource source(BatchSource::MANIFEST, manifestPath, outputDir,
+                       [this](const std::string& file) { return isValidImageFormat(file); },
+                       getBatchSourceOptions());
+    return runBatch(source, manifestPath, outputDir);
+}
+
+BatchSource::Options FaceEnhancer::getBatchSourceOptions() const {
+    BatchSource::Options options;
+    options.probeHeaders = params_.probeBatchInputs;
+    return options;
+}
+
+bool FaceEnhancer::runBatch(BatchSource& source, const std::string& inputName, const std::string& outputDir) {
     try {
         // Create output directory if it doesn't exist
-        if (!Utils::createDirectory(outputDir)) {
-            Utils::logError("Failed to create output directory: " + outputDir);
+        if (!Utils::directoryExists(outputDir) && !Utils::createDirectory(outputDir)) {
+            Utils::logError("Failed to create output directory: ", outputDir);
             return false;
         }
 
-        // Get list of image files
-        std::vector<std::string> imageFiles = Utils::listFiles(inputDir);
-        std::vector<std::string> validImages;
+        Utils::logInfo("Processing images from ", inputName, " as they are found");
+
+        int successCount = 0;
+        int attempted = 0;
+        int routeCounts[3] = {0, 0, 0};
+        double totalTimeSaved = 0.0;
+        std::string lastOutputParent;
+        const EnhancementParams batchParams = params_;
+        
+        // Encodes overlap with enhancement of the next image; only their results are awaited
+        ImageEncoder encoder(params_.encoderThreads);
+        struct PendingSave {
+            BatchSource::Item item;
+            uint64_t paramsHash;
+            uint64_t contentHash;
+            std::future<bool> saved;
+        };
+        std::deque<PendingSave> pendingSaves;
         
-        for (const auto& file : imageFiles) {
-            if (isValidImageFormat(file)) {
-                validImages.push_back(file);
+        // The journal lets a rerun skip inputs already enhanced with the same parameters
+        std::unique_ptr<BatchJournal> journal;
+        int skippedCount = 0;
+        if (params_.resumeBatch) {
+            std::string journalPath = params_.journalPath.empty() ? Utils::joinPath(outputDir, ".face_enhancer_journal")
+                                                                  : params_.journalPath;
+            journal = std::make_unique<BatchJournal>(journalPath);
+            if (!journal->open()) {
+                Utils::logWarning("Continuing without batch journal");
+                journal.reset();
             }
         }
+        
+        auto collectSave = [&](PendingSave& pending) {
+            if (pending.saved.get()) {
+                successCount++;
+                if (journal) {
+                    journal->record(pending.item.inputPath, pending.item.outputPath, pending.paramsHash, pending.contentHash);
+                }
+            } else {
+                Utils::logLimited(Utils::LOG_WARNING, "batch.save", "Failed to save: ", pending.item.name);
+            }
+        };
+        
+        // A short lookahead of queued items keeps readahead running on the next few files
+        const size_t readahead = params_.memoryMappedInput ? static_cast<size_t>(std::max(0, params_.readaheadFiles)) : 0;
+        std::deque<BatchSource::Item> lookahead;
+        auto refill = [&]() {
+            BatchSource::Item next;
+            while (lookahead.size() <= readahead && source.next(next)) {
+                if (readahead > 0) Utils::prefetchFile(next.inputPath);
+                lookahead.push_back(std::move(next));
+            }
+        };
+        
+        // With the DNN detector, decoded images are grouped so one forward pass finds faces for all of them
+        struct PreparedItem {
+            BatchSource::Item item;
+            EnhancementParams params;  // batch parameters plus this item's overrides
+            uint64_t paramsHash;
+            uint64_t contentHash;  // of the bytes decoded, for the journal
+            cv::Mat input;
+        };
+        const size_t detectionBatch = faceDetector_->hasDNNDetector() ? static_cast<size_t>(faceDetector_->getDNNBatchSize()) : 1;
+        std::vector<PreparedItem> group;
+        
+        auto enhanceGroup = [&]() {
+            std::vector<std::vector<cv::Rect>> groupFaces;
+            double groupDetectionMs = 0.0;
+            if (detectionBatch > 1) {
+                std::vector<cv::Mat> images;
+                for (const auto& prepared : group) {
+                    images.push_back(prepared.input);
+                }
+                auto detectStart = std::chrono::high_resolution_clock::now();
+                {
+                    Tracer::Span traceSpan("Batched Face Detection");
+                    MemoryTracker::StageScope memoryStage(kFaceDetectionStage);
+                    groupFaces = faceDetector_->detectFacesDNNBatch(images, batchParams.dnnConfidence);
+                }
+                groupDetectionMs = Utils::getElapsedTime(detectStart);
+                Utils::logDebug("Detected faces in ", images.size(), " images in ", groupDetectionMs, " ms");
+            }
+            
+            for (size_t i = 0; i < group.size(); ++i) {
+                PreparedItem& prepared = group[i];
+                Tracer::ImageScope traceImage(Tracer::isEnabled() ? prepared.item.name : std::string());
+                params_ = prepared.params;
+                
+                KnownFaces knownFaces;
+                if (!groupFaces.empty()) {
+                    knownFaces.faces = &groupFaces[i];
+                    knownFaces.detectionMs = groupDetectionMs / group.size();
+                }
+                
+                cv::Mat outputImage;
+                if (enhanceDecoded(prepared.input, outputImage, knownFaces)) {
+                    routeCounts[lastRouting_.route]++;
+                    totalTimeSaved += lastRouting_.timeSavedMs;
+                    std::future<bool> saved = encoder.saveAsync(outputImage, prepared.item.outputPath,
+                                                                params_.outputQuality, params_.encodePreset);
+                    pendingSaves.push_back({std::move(prepared.item), prepared.paramsHash, prepared.contentHash,
+                                            std::move(saved)});
+                } else {
+                    Utils::logLimited(Utils::LOG_WARNING, "batch.enhance", "Failed to enhance: ", prepared.item.name);
+                }
+            }
+            params_ = batchParams;
+            group.clear();
+            
+            // Retire saves that have already finished so the pending list stays short
+            while (!pendingSaves.empty() &&
+                   pendingSaves.front().saved.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                collectSave(pendingSaves.front());
+                pendingSaves.pop_front();
+            }
+        };
+        
+        refill();
+        while (!lookahead.empty()) {
+            BatchSource::Item item = std::move(lookahead.front());
+            lookahead.pop_front();
+            refill();
+            attempted++;
+            Tracer::ImageScope traceImage(Tracer::isEnabled() ? item.name : std::string());
+            
+            // Mirrored trees need their output directories; consecutive items usually share one
+            std::string outputParent = std::filesystem::path(item.outputPath).parent_path().string();
+            if (!outputParent.empty() && outputParent != lastOutputParent) {
+                if (!Utils::directoryExists(outputParent) && !Utils::createDirectory(outputParent)) {
+                    Utils::logLimited(Utils::LOG_WARNING, "batch.mkdir", "Failed to create output directory for: ", item.name);
+                    continue;
+                }
+                lastOutputParent = outputParent;
+            }
+            
+            // Manifest overrides apply to this image only
+            for (const auto& entry : item.overrides) {
+                if (!applyParamOverride(params_, entry.first, entry.second)) {
+                    Utils::logLimited(Utils::LOG_WARNING, "batch.override", "Ignoring override ", entry.first, "=",
+                                      entry.second, " for ", item.name);
+                }
+            }
+            
+            // Huge images take the memory-safe path: decoded no larger than the pixel cap, no super resolution.
+            // Only JPEG can decode at reduced size; any other format would be decoded in full first
+            int maxInputSide = 0;
+            if (params_.maxInputPixels > 0 && item.probe.valid && item.probe.pixelCount() > params_.maxInputPixels) {
+                cv::Size size = item.probe.orientedSize();
+                if (item.probe.format != ImageProbe::FORMAT_JPEG) {
+                    Utils::logLimited(Utils::LOG_WARNING, "batch.large", "Skipping ", item.name, ": ", size.width, "x",
+                                      size.height, " exceeds the input pixel limit and cannot be decoded at reduced size");
+                    params_ = batchParams;
+                    continue;
+                }
+                double shrink = std::sqrt(static_cast<double>(params_.maxInputPixels) / item.probe.pixelCount());
+                maxInputSide = std::max(1, static_cast<int>(std::max(size.width, size.height) * shrink));
+                params_.srScale = 1;
+                Utils::logLimited(Utils::LOG_INFO, "batch.large", "Large input ", item.name, " (", size.width, "x",
+                                  size.height, ") limited to ", maxInputSide, " px");
+            }
+            
+            uint64_t paramsHash = getParamsHash();
+            if (journal && journal->isUpToDate(item.inputPath, item.outputPath, paramsHash)) {
+                skippedCount++;
+            } else {
+                uint64_t contentHash = 0;
+                cv::Mat input = loadInput(item.inputPath, maxInputSide, journal ? &contentHash : nullptr);
+                if (!input.empty()) {
+                    group.push_back({std::move(item), params_, paramsHash, contentHash, input});
+                } else {
+                    Utils::logLimited(Utils::LOG_WARNING, "batch.enhance", "Failed to enhance: ", item.name);
+                }
+            }
+            params_ = batchParams;
+            
+            if (group.size() >= detectionBatch) {
+                enhanceGroup();
+            }
+            
+            if (attempted % 100 == 0) {
+                Utils::logInfo("Processed ", attempted, " of ", source.getDiscoveredCount(), " images found so far");
+            }
+        }
+        if (!group.empty()) {
+            enhanceGroup();
+        }
 
-        if (validImages.empty()) {
-            Utils::logWarning("No valid image files found in: " + inputDir);
+        for (auto& pending : pendingSaves) {
+            collectSave(pending);
+        }
+        
+        if (source.getRejectedCount() > 0) {
+            Utils::logInfo("Rejected ", source.getRejectedCount(), " corrupt or undersized images before decode");
+        }
+        
+        if (attempted == 0) {
+            Utils::logWarning("No valid image files found in: ", inputName);
             return true;
         }
+        
+        Utils::logInfo("Batch processing completed. Successfully enhanced ", successCount, "/",
+                       attempted - skippedCount, " images");
+        if (journal) {
+            Utils::logInfo("Skipped ", skippedCount, " up-to-date images recorded in ", journal->getPath());
+        }
+        
+        if (params_.adaptiveRouting) {
+            Utils::logInfo("Routes: ", routeCounts[ROUTE_SKIP], " skip, ", routeCounts[ROUTE_LIGHT], " light, ",
+                           routeCounts[ROUTE_FULL], " full; est. time saved ", totalTimeSaved, " ms");
+        }
 
-        Utils::logInfo("Processing " + std::to_string(validImages.size()) + " images");
-        Utils::ProgressBar progress(validImages.size(), "Enhancing images");
+        return successCount > 0 || skippedCount == attempted;
 
-        int successCount = 0;
-        for (size_t i = 0; i < validImages.size(); ++i) {
-            std::string inputPath = Utils::joinPath(inputDir, validImages[i]);
-            std::string outputPath = Utils::joinPath(outputDir, "enhanced_" + validImages[i]);
+    } catch (const std::exception& e) {
+        Utils::logError("Exception in batch enhancement: ", e.what());
+        return false;
+    }
+}
+
+uint64_t FaceEnhancer::getParamsHash() const {
+    // Only settings that change the output bytes; I/O and threading knobs are left out
+    std::ostringstream fingerprint;
+    fingerprint << params_.sharpenStrength << '|' << params_.sharpenRadius << '|'
+                << params_.noiseReductionStrength << '|' << params_.templateWindowSize << '|' << params_.searchWindowSize << '|'
+                << params_.srScale << '|' << params_.maxOutputSide << '|' << params_.maxInputPixels << '|'
+                << params_.outputQuality << '|' << params_.encodePreset << '|'
+                << params_.edgeEnhancementStrength << '|' << params_.skinSmoothingStrength << '|'
+                << params_.alpha << '|' << params_.beta << '|'
+                << params_.useHistogramEqualization << '|' << params_.useCLAHE << '|' << params_.claheClipLimit << '|'
+                << params_.landmarkModelPath << '|' << params_.landmarkGuidedDetail << '|'
+                << params_.dnnModelPath << '|' << params_.dnnConfigPath << '|' << params_.dnnConfidence << '|'
+                << params_.adaptiveRouting << '|' << params_.skipQualityThreshold << '|' << params_.lightQualityThreshold;
+    
+    std::string text = fingerprint.str();
+    return BatchJournal::hashBytes(text.data(), text.size());
+}
+
+bool FaceEnhancer::applyParamOverride(EnhancementParams& params, const std::string& key, const std::string& value) {
+    try {
+        // Keys follow the command-line option names
+        if (key == "sharpen") params.sharpenStrength = std::stod(value);
+        else if (key == "denoise") params.noiseReductionStrength = std::stof(value);
+        else if (key == "contrast") params.alpha = std::stod(value);
+        else if (key == "brightness") params.beta = std::stoi(value);
+        else if (key == "scale") params.srScale = std::stoi(value);
+        else if (key == "max-size") params.maxOutputSide = std::max(0, std::stoi(value));
+        else if (key == "quality") params.outputQuality = std::stoi(value);
+        else return false;
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool FaceEnhancer::enhanceStream(std::istream& input, std::ostream& output, const std::string& outputFormat) {
+    struct StreamImage {
+        int index = 0;
+        cv::Mat image;
+        std::string format;  // reply encoding
+    };
+
+    try {
+        // Reading, enhancing and encoding overlap; replies still leave in arrival order
+        const size_t streamQueueDepth = 4;
+        Utils::BoundedQueue<StreamImage> decodedImages(streamQueueDepth);
+        Utils::BoundedQueue<StreamImage> enhancedImages(streamQueueDepth);
+        std::atomic<bool> inputFailed(false);
+        std::atomic<bool> outputFailed(false);
+        int failed = 0;
+
+        // Once output has failed the reader stops before its next message. A read already blocked
+        // on the input can't be interrupted, so shutdown waits for that message or end of input
+        std::thread reader([&]() {
+            Tracer::setThreadName("stream reader");
+            try {
+                std::vector<uchar> bytes;
+                int index = 0;
+                while (!outputFailed && readStreamMessage(input, bytes)) {
+                    StreamImage message;
+                    message.index = index++;
+                    message.format = outputFormat.empty() ? detectStreamFormat(bytes) : outputFormat;
+                    if (!bytes.empty()) {
+                        Tracer::Span traceSpan("Decode", "io");
+                        message.image = cv::imdecode(bytes, cv::IMREAD_COLOR);
+                    }
+                    if (message.image.empty()) {
+                        Utils::logLimited(Utils::LOG_WARNING, "stream.decode", "Failed to decode stream image ", message.index);
+                    }
+                    if (!decodedImages.push(std::move(message))) break;
+                }
+                // Only a clean end of input leaves the stream at EOF; an oversized length prefix does not
+                if (!outputFailed && !input.eof()) inputFailed = true;
+            } catch (const std::exception& e) {
+                Utils::logError("Exception reading stream input: ", e.what());
+                inputFailed = true;
+            }
+            decodedImages.close();
+        });
+
+        std::thread writer([&]() {
+            Tracer::setThreadName("stream writer");
+            try {
+                StreamImage message;
+                std::vector<uchar> encoded;
+                while (enhancedImages.pop(message)) {
+                    Tracer::Span traceSpan("Encode", "io");
+                    encoded.clear();
+                    if (!message.image.empty() &&
+                        !cv::imencode(message.format, message.image, encoded,
+                                      ImageProcessor::getEncodeParams(message.format, params_.outputQuality, params_.encodePreset))) {
+                        Utils::logLimited(Utils::LOG_WARNING, "stream.encode", "Failed to encode stream image ", message.index);
+                        encoded.clear();
+                    }
+                    
+                    if (!writeStreamMessage(output, encoded)) {
+                        Utils::logError("Failed to write stream output");
+                        outputFailed = true;
+                        break;
+                    }
+                }
+            } catch (const std::exception& e) {
+                Utils::logError("Exception writing stream output: ", e.what());
+                outputFailed = true;
+            }
+            if (outputFailed) {
+                enhancedImages.close();
+                decodedImages.close();
+            }
+        });
+
+        int processed = 0;
+        bool enhanceFailed = false;
+        try {
+            StreamImage message;
+            while (decodedImages.pop(message)) {
+                Tracer::ImageScope traceImage(Tracer::isEnabled() ? "image " + std::to_string(message.index) : std::string());
+                StreamImage reply;
+                reply.index = message.index;
+                reply.format = message.format;
+                
+                // Failed images still get a (empty) reply so the caller can pair them up
+                if (message.image.empty() || !enhanceImage(message.image, reply.image)) {
+                    reply.image.release();
+                    failed++;
+                } else {
+                    applyOutputCap(reply.image);
+                }
+                
+                if (!enhancedImages.push(std::move(reply))) break;
+                processed++;
+            }
+        } catch (const std::exception& e) {
+            Utils::logError("Exception enhancing stream images: ", e.what());
+            enhanceFailed = true;
+        }
+
+        decodedImages.close();
+        enhancedImages.close();
+        reader.join();
+        writer.join();
+
+        Utils::logInfo("Stream processing completed: ", processed, " images, ", failed, " failed");
+
+        return !inputFailed && !outputFailed && !enhanceFailed;
+
+    } catch (const std::exception& e) {
+        Utils::logError("Exception in stream enhancement: ", e.what());
+        return false;
+    }
+}
+
+bool FaceEnhancer::enhanceVideo(const std::string& inputPath, const std::string& outputPath) {
+    struct VideoFrame {
+        int index = 0;
+        cv::Mat image;
+    };
+
+    try {
+        cv::VideoCapture capture(inputPath);
+        if (!capture.isOpened()) {
+            Utils::logError("Failed to open video: ", inputPath);
+            return false;
+        }
+
+        double fps = capture.get(cv::CAP_PROP_FPS);
+        if (fps <= 0.0) fps = 25.0;
+        int totalFrames = static_cast<int>(capture.get(cv::CAP_PROP_FRAME_COUNT));
+        
+        std::string ext = Utils::toLowerCase(Utils::getFileExtension(outputPath));
+        int fourcc = ext == ".avi" ? cv::VideoWriter::fourcc('M', 'J', 'P', 'G')
+                                   : cv::VideoWriter::fourcc('m', 'p', '4', 'v');
+
+        Utils::logInfo("Processing video: ", inputPath, " (", totalFrames, " frames at ", fps, " fps)");
+
+        // Decode, enhance and encode run on separate threads joined by bounded queues
+        Utils::BoundedQueue<VideoFrame> decodedFrames(videoParams_.queueDepth);
+        Utils::BoundedQueue<VideoFrame> enhancedFrames(videoParams_.queueDepth);
+        bool writerFailed = false;
+
+        std::thread decoder([&]() {
+            Tracer::setThreadName("video decoder");
+            int index = 0;
+            while (true) {
+                VideoFrame frame;
+                {
+                    Tracer::Span traceSpan("Decode", "io");
+                    if (!capture.read(frame.image) || frame.image.empty()) break;
+                }
+                frame.index = index++;
+                if (!decodedFrames.push(std::move(frame))) break;
+            }
+            decodedFrames.close();
+        });
+
+        std::thread encoder([&]() {
+            Tracer::setThreadName("video encoder");
+            cv::VideoWriter writer;
+            cv::Size frameSize;
+            VideoFrame frame;
             
-            if (enhanceImage(inputPath, outputPath)) {
-                successCount++;
-            } else {
-                Utils::logWarning("Failed to enhance: " + validImages[i]);
+            while (enhancedFrames.pop(frame)) {
+                if (!writer.isOpened()) {
+                    frameSize = frame.image.size();
+                    if (!writer.open(outputPath, fourcc, fps, frameSize)) {
+                        Utils::logError("Failed to open video writer: ", outputPath);
+                        writerFailed = true;
+                        enhancedFrames.close();
+                        decodedFrames.close();
+                        break;
+                    }
+                }
+                
+                // Frames passed through after a pipeline failure keep the stream size uniform
+                if (frame.image.size() != frameSize) {
+                    cv::resize(frame.image, frame.image, frameSize, 0, 0, cv::INTER_LINEAR);
+                }
+                Tracer::Span traceSpan("Encode", "io");
+                writer.write(frame.image);
             }
+            writer.release();
+        });
+
+        FaceTracker tracker(videoParams_.trackingMinScore);
+        TemporalDenoiser denoiser(videoParams_.temporalWindow,
+                                  videoParams_.temporalNLM ? TemporalDenoiser::NLM_MULTI : TemporalDenoiser::MOTION_COMPENSATED_MEAN,
+                                  params_.noiseReductionStrength);
+        int temporallyDenoised = 0;
+        std::array<uint32_t, 256> previousHistogram{};
+        bool hasPrevious = false;
+        bool redetect = true;
+        int framesSinceDetection = 0;
+        int detections = 0;
+        int sceneCuts = 0;
+        int processed = 0;
+        Utils::ProgressBar progress(std::max(totalFrames, 1), "Enhancing video");
+
+        // Worker threads must always be joined, so failures here only stop the stream
+        bool enhanceFailed = false;
+        try {
+            VideoFrame frame;
+            while (decodedFrames.pop(frame)) {
+                Tracer::ImageScope traceImage(Tracer::isEnabled() ? "frame " + std::to_string(frame.index) : std::string());
+                bool sceneCut = isSceneCut(frame.image, previousHistogram, hasPrevious);
+                if (sceneCut) {
+                    sceneCuts++;
+                    denoiser.reset();  // frames across a cut can't be aligned
+                }
+            
+                std::vector<cv::Rect> faces;
+                KnownFaces knownFaces;
+                knownFaces.faces = &faces;
+                auto faceStartTime = std::chrono::high_resolution_clock::now();
+                const bool detect = redetect || sceneCut || framesSinceDetection >= videoParams_.detectionInterval;
+                {
+                    Tracer::Span traceSpan(detect ? "Face Detection" : "Face Tracking");
+                    if (detect) {
+                        faces = detectFaces(frame.image);
+                        tracker.reset(frame.image, faces);
+                        framesSinceDetection = 0;
+                        detections++;
+                        redetect = false;
+                    } else {
+                        size_t tracked = tracker.size();
+                        faces = tracker.track(frame.image);
+                        redetect = faces.size() < tracked;  // a lost face forces detection next frame
+                    }
+                }
+                knownFaces.tracked = !detect;
+                knownFaces.detectionMs = Utils::getElapsedTime(faceStartTime);
+                framesSinceDetection++;
+
+                // Denoise from the aligned frame stack; frames without temporal support keep spatial NLM
+                cv::Mat source = frame.image;
+                bool preDenoised = false;
+                if (videoParams_.temporalWindow > 1) {
+                    auto denoiseStartTime = std::chrono::high_resolution_clock::now();
+                    preDenoised = denoiser.denoise(frame.image, source);
+                    if (preDenoised) {
+                        temporallyDenoised++;
+                        logProcessingStep("Temporal Denoising", Utils::getElapsedTime(denoiseStartTime));
+                    }
+                }
+
+                VideoFrame output;
+                output.index = frame.index;
+                if (!runPipeline(source, output.image, knownFaces, preDenoised)) {
+                    Utils::logLimited(Utils::LOG_WARNING, "video.enhance", "Failed to enhance frame ", frame.index,
+                                      ", passing it through");
+                    output.image = frame.image;
+                }
             
-            progress.update(i + 1);
+                if (!enhancedFrames.push(std::move(output))) break;
+                processed++;
+                if (totalFrames > 0) progress.update(std::min(processed, totalFrames));
+            }
+        } catch (const std::exception& e) {
+            Utils::logError("Exception enhancing video frames: ", e.what());
+            enhanceFailed = true;
         }
 
+        decodedFrames.close();
+        enhancedFrames.close();
+        decoder.join();
+        encoder.join();
         progress.finish();
-        Utils::logInfo("Batch processing completed. Successfully enhanced " + 
-                      std::to_string(successCount) + "/" + std::to_string(validImages.size()) + " images");
 
-        return successCount > 0;
+        Utils::logInfo("Video processing completed: ", processed, " frames, ", detections, " detections, ", sceneCuts,
+                       " scene cuts, ", temporallyDenoised, " temporally denoised");
+
+        return !writerFailed && !enhanceFailed && processed > 0;
 
     } catch (const std::exception& e) {
-        Utils::logError("Exception in batch enhancement: " + std::string(e.what()));
+        Utils::logError("Exception in video enhancement: ", e.what());
         return false;
     }
 }
 
 void FaceEnhancer::setEnhancementParams(const EnhancementParams& params) {
+    // The landmark model is large, so it is only loaded when its path changes
+    if (!params.landmarkModelPath.empty() && params.landmarkModelPath != params_.landmarkModelPath) {
+        faceDetector_->initializeLandmarkDetector(params.landmarkModelPath);
+    }
+    if (!params.dnnModelPath.empty() &&
+        (params.dnnModelPath != params_.dnnModelPath || params.dnnConfigPath != params_.dnnConfigPath)) {
+        faceDetector_->initializeDNNDetector(params.dnnModelPath, params.dnnConfigPath);
+    }
+    faceDetector_->setDNNBatchSize(params.dnnBatchSize);
+    
     params_ = params;
     Utils::logInfo("Enhancement parameters updated");
 }
@@ -206,12 +956,34 @@ std::vector<std::string> FaceEnhancer::getSupportedFormats() const {
     return {".jpg", ".jpeg", ".png", ".bmp", ".tiff", ".tif", ".webp"};
 }
 
+std::string FaceEnhancer::getRouteName(PipelineRoute route) {
+    switch (route) {
+        case ROUTE_SKIP: return "skip";
+        case ROUTE_LIGHT: return "light";
+        case ROUTE_FULL: return "full";
+        default: return "unknown";
+    }
+}
+
 // Private methods implementation
 
 cv::Mat FaceEnhancer::sharpenImage(const cv::Mat& image) {
     return EnhancementAlgorithms::unsharpMask(image, params_.sharpenStrength, params_.sharpenRadius);
 }
 
+cv::Mat FaceEnhancer::sharpenOutside(const cv::Mat& image, const cv::Mat& smoothOnlyMask) {
+    // The filter runs over the whole frame so feature and face-edge borders match an unmasked pass
+    cv::Mat result = sharpenImage(image);
+    image.copyTo(result, smoothOnlyMask);
+    return result;
+}
+
+cv::Mat FaceEnhancer::enhanceEdgesOutside(const cv::Mat& image, const cv::Mat& smoothOnlyMask) {
+    cv::Mat result = enhanceEdges(image);
+    image.copyTo(result, smoothOnlyMask);
+    return result;
+}
+
 cv::Mat FaceEnhancer::reduceNoise(const cv::Mat& image) {
     if (image.channels() == 3) {
         return EnhancementAlgorithms::nonLocalMeansDenoising(image, 
@@ -272,16 +1044,167 @@ std::vector<cv::Rect> FaceEnhancer::detectFaces(const cv::Mat& image) {
     std::vector<cv::Rect> faces;
     
     try {
-        if (!faceCascade_.empty()) {
+        if (faceDetector_->hasDNNDetector()) {
+            faces = faceDetector_->detectFacesDNN(image, params_.dnnConfidence);
+        } else if (!faceCascade_.empty()) {
             faceCascade_.detectMultiScale(image, faces, 1.1, 3, 0, cv::Size(30, 30));
         }
     } catch (const std::exception& e) {
-        Utils::logWarning("Face detection failed: " + std::string(e.what()));
+        Utils::logWarning("Face detection failed: ", e.what());
     }
     
     return faces;
 }
 
+FaceEnhancer::RoutingDecision FaceEnhancer::routePipeline(const cv::Mat& image, const std::vector<cv::Rect>& faces) {
+    RoutingDecision decision;
+    
+    // Score the whole image on a small proxy; faces are scored in place on the frame
+    const double maxProxySide = 512.0;
+    double scale = std::min(1.0, maxProxySide / std::max(image.cols, image.rows));
+    cv::Mat proxy = image;
+    if (scale < 1.0) {
+        cv::resize(image, proxy, cv::Size(), scale, scale, cv::INTER_AREA);
+    }
+    decision.imageQuality = faceDetector_->assessFaceQuality(ImageStats::compute(proxy));
+    decision.minFaceQuality = faces.empty() ? decision.imageQuality : 1.0;
+    
+    bool facesNeedWork = false;
+    for (const auto& face : faces) {
+        ImageStats faceStats = ImageStats::compute(image, face);
+        if (faceStats.pixelCount == 0) continue;
+        
+        decision.minFaceQuality = std::min(decision.minFaceQuality, faceDetector_->assessFaceQuality(faceStats));
+        if (faceDetector_->isFaceBlurred(faceStats) || !faceDetector_->isFaceWellLit(faceStats)) {
+            facesNeedWork = true;
+        }
+    }
+    
+    if (facesNeedWork || decision.imageQuality < params_.lightQualityThreshold) {
+        decision.route = ROUTE_FULL;
+    } else if (decision.imageQuality >= params_.skipQualityThreshold &&
+               decision.minFaceQuality >= params_.skipQualityThreshold) {
+        decision.route = ROUTE_SKIP;
+    } else {
+        decision.route = ROUTE_LIGHT;
+    }
+    
+    return decision;
+}
+
+bool FaceEnhancer::readStreamMessage(std::istream& input, std::vector<uchar>& bytes) {
+    unsigned char header[4];
+    if (!input.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;  // clean end of stream, or a truncated header
+    }
+    
+    uint32_t length = static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+                      (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+    if (length > kMaxStreamMessageBytes) {
+        Utils::logError("Stream message of ", length, " bytes exceeds the ", Utils::formatFileSize(kMaxStreamMessageBytes),
+                        " limit; treating the stream as corrupt");
+        return false;
+    }
+    bytes.resize(length);
+    if (length > 0 && !input.read(reinterpret_cast<char*>(bytes.data()), length)) {
+        Utils::logError("Truncated stream message: expected ", length, " bytes");
+        return false;
+    }
+    
+    return true;
+}
+
+bool FaceEnhancer::writeStreamMessage(std::ostream& output, const std::vector<uchar>& bytes) {
+    uint32_t length = static_cast<uint32_t>(bytes.size());
+    unsigned char header[4] = {
+        static_cast<unsigned char>(length & 0xFF), static_cast<unsigned char>((length >> 8) & 0xFF),
+        static_cast<unsigned char>((length >> 16) & 0xFF), static_cast<unsigned char>((length >> 24) & 0xFF)
+    };
+    
+    output.write(reinterpret_cast<const char*>(header), sizeof(header));
+    if (!bytes.empty()) {
+        output.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+    output.flush();  // callers wait on each reply
+    return static_cast<bool>(output);
+}
+
+std::string FaceEnhancer::detectStreamFormat(const std::vector<uchar>& bytes) {
+    // Replies keep the input's container where it is one we can write
+    if (bytes.size() >= 3 && bytes[0] == 0xFF && bytes[1] == 0xD8 && bytes[2] == 0xFF) return ".jpg";
+    if (bytes.size() >= 12 && bytes[0] == 'R' && bytes[1] == 'I' && bytes[2] == 'F' && bytes[3] == 'F' &&
+        bytes[8] == 'W' && bytes[9] == 'E' && bytes[10] == 'B' && bytes[11] == 'P') return ".webp";
+    if (bytes.size() >= 2 && bytes[0] == 'B' && bytes[1] == 'M') return ".bmp";
+    if (bytes.size() >= 4 && ((bytes[0] == 'I' && bytes[1] == 'I') || (bytes[0] == 'M' && bytes[1] == 'M'))) return ".tiff";
+    return ".png";
+}
+
+bool FaceEnhancer::isSceneCut(const cv::Mat& frame, std::array<uint32_t, 256>& previousHistogram, bool& hasPrevious) {
+    // Luma histograms of a small proxy; a cut shows as a large total variation distance
+    const double proxyWidth = 160.0;
+    cv::Mat proxy;
+    double scale = std::min(1.0, proxyWidth / frame.cols);
+    cv::resize(frame, proxy, cv::Size(), scale, scale, cv::INTER_AREA);
+    
+    ImageStats stats = ImageStats::compute(proxy);
+    if (stats.pixelCount == 0) return false;
+    
+    bool cut = false;
+    if (hasPrevious) {
+        uint64_t previousCount = 0;
+        for (uint32_t n : previousHistogram) previousCount += n;
+        
+        double distance = 0.0;
+        for (int level = 0; level < 256; ++level) {
+            distance += std::abs(static_cast<double>(stats.histogram[level]) / stats.pixelCount -
+                                 static_cast<double>(previousHistogram[level]) / std::max<uint64_t>(previousCount, 1));
+        }
+        cut = distance / 2.0 > videoParams_.sceneCutThreshold;
+    }
+    
+    previousHistogram = stats.histogram;
+    hasPrevious = true;
+    return cut;
+}
+
+void FaceEnhancer::recordStageCost(const std::string& step, double processingTime, double megapixels) {
+    logProcessingStep(step, processingTime);
+    if (megapixels <= 0.0) return;
+    
+    // Exponential moving average keeps the estimate current across a batch
+    double costPerMegapixel = processingTime / megapixels;
+    auto it = stageCostPerMegapixel_.find(step);
+    if (it == stageCostPerMegapixel_.end()) {
+        stageCostPerMegapixel_[step] = costPerMegapixel;
+    } else {
+        it->second = 0.8 * it->second + 0.2 * costPerMegapixel;
+    }
+}
+
+double FaceEnhancer::estimateSkippedTime(PipelineRoute route, bool hasFaces, double megapixels) const {
+    std::vector<std::string> skipped;
+    if (route == ROUTE_SKIP) {
+        skipped = {"Sharpening", "Brightness/Contrast", "Histogram Enhancement"};
+    }
+    if (route != ROUTE_FULL) {
+        skipped.push_back("Noise Reduction");
+        skipped.push_back("Edge Enhancement");
+        if (hasFaces) {
+            skipped.push_back("Skin Smoothing");
+        }
+    }
+    
+    // Stages never seen on the full route contribute nothing to the estimate
+    double saved = 0.0;
+    for (const auto& step : skipped) {
+        auto it = stageCostPerMegapixel_.find(step);
+        if (it != stageCostPerMegapixel_.end()) {
+            saved += it->second * megapixels;
+        }
+    }
+    return saved;
+}
+
 bool FaceEnhancer::initializeFaceDetector() {
     try {
         // Try to load the default Haar cascade for face detection
@@ -310,7 +1233,7 @@ bool FaceEnhancer::initializeFaceDetector() {
             return false;
         }
     } catch (const std::exception& e) {
-        Utils::logError("Failed to initialize face detector: " + std::string(e.what()));
+        Utils::logError("Failed to initialize face detector: ", e.what());
         return false;
     }
 }
@@ -347,5 +1270,7 @@ cv::Mat FaceEnhancer::postprocessImage(const cv::Mat& image) {
 }
 
 void FaceEnhancer::logProcessingStep(const std::string& step, double processingTime) {
-    Utils::logDebug(step + " completed in " + std::to_string(processingTime) + " ms");
+    lastStageTimes_.emplace_back(step, processingTime);
+    Tracer::recordCompleted(step, processingTime);
+    Utils::logDebug(step, " completed in ", processingTime, " ms");
 }
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "face_tracker.h"
+#include "utils.h"
+
+FaceTracker::FaceTracker(double minScore, double searchMargin)
+    : minScore_(minScore)
+    , searchMargin_(searchMargin) {
+}
+
+void FaceTracker::reset(const cv::Mat& frame, const std::vector<cv::Rect>& faces) {
+    tracks_.clear();
+    if (frame.empty()) return;
+
+    try {
+        cv::Mat gray = toGray(frame);
+        cv::Rect frameRect(0, 0, gray.cols, gray.rows);
+
+        for (const auto& face : faces) {
+            cv::Rect safeFace = face & frameRect;
+            if (safeFace.area() == 0) continue;
+
+            // Templates outlive the frame buffer, so they are copied
+            tracks_.push_back({safeFace, gray(safeFace).clone()});
+        }
+    } catch (const std::exception& e) {
+        Utils::logError("Exception seeding face tracker: ", e.what());
+        tracks_.clear();
+    }
+}
+
+std::vector<cv::Rect> FaceTracker::track(const cv::Mat& frame) {
+    std::vector<cv::Rect> faces;
+    if (frame.empty() || tracks_.empty()) return faces;
+
+    try {
+        cv::Mat gray = toGray(frame);
+        cv::Rect frameRect(0, 0, gray.cols, gray.rows);
+        std::vector<Track> kept;
+
+        for (auto& track : tracks_) {
+            int marginX = static_cast<int>(track.rect.width * searchMargin_);
+            int marginY = static_cast<int>(track.rect.height * searchMargin_);
+            cv::Rect window = cv::Rect(track.rect.x - marginX, track.rect.y - marginY,
+                                       track.rect.width + 2 * marginX, track.rect.height + 2 * marginY) & frameRect;
+
+            if (window.width < track.templ.cols || window.height < track.templ.rows) continue;
+
+            cv::Mat response;
+            cv::matchTemplate(gray(window), track.templ, response, cv::TM_CCOEFF_NORMED);
+
+            double maxScore = 0.0;
+            cv::Point maxLoc;
+            cv::minMaxLoc(response, nullptr, &maxScore, nullptr, &maxLoc);
+            if (maxScore < minScore_) continue;
+
+            track.rect = cv::Rect(window.x + maxLoc.x, window.y + maxLoc.y, track.rect.width, track.rect.height);
+            faces.push_back(track.rect);
+            kept.push_back(std::move(track));
+        }
+
+        tracks_ = std::move(kept);
+    } catch (const std::exception& e) {
+        Utils::logError("Exception tracking faces: ", e.what());
+        tracks_.clear();
+        faces.clear();
+    }
+
+    return faces;
+}
+
+cv::Mat FaceTracker::toGray(const cv::Mat& frame) {
+    if (frame.channels() == 1) return frame;
+
+    cv::Mat gray;
+    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    return gray;
+}
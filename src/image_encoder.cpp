@@ -0,0 +1,61 @@
+#include "image_encoder.h"
+#include "tracer.h"
+#include <algorithm>
+
+ImageEncoder::ImageEncoder(int threads, size_t queueDepth)
+    : jobs_(queueDepth) {
+    int count = std::max(1, threads);
+    workers_.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        workers_.emplace_back(&ImageEncoder::workerLoop, this);
+    }
+}
+
+ImageEncoder::~ImageEncoder() {
+    shutdown();
+}
+
+std::future<bool> ImageEncoder::saveAsync(const cv::Mat& image, const std::string& path, int quality,
+                                          ImageProcessor::EncodePreset preset) {
+    Job job;
+    job.image = image;
+    job.path = path;
+    job.quality = quality;
+    job.preset = preset;
+    std::future<bool> result = job.result.get_future();
+
+    // Blocks while the queue is full, which throttles producers to encoder speed
+    if (!jobs_.push(std::move(job))) {
+        Utils::logError("Encoder pool is shut down, cannot save: ", path);
+        std::promise<bool> failed;
+        failed.set_value(false);
+        return failed.get_future();
+    }
+
+    return result;
+}
+
+void ImageEncoder::shutdown() {
+    // Queued jobs still drain before the workers exit
+    jobs_.close();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void ImageEncoder::workerLoop() {
+    Tracer::setThreadName("encoder");
+    Job job;
+    while (jobs_.pop(job)) {
+        bool saved = false;
+        try {
+            Tracer::ImageScope traceImage(Tracer::isEnabled() ? Utils::getBasename(job.path) : std::string());
+            Tracer::Span traceSpan("Encode", "io");
+            saved = ImageProcessor::saveImage(job.image, job.path, job.quality, job.preset);
+        } catch (const std::exception& e) {
+            Utils::logError("Exception in encoder thread: ", e.what());
+        }
+        job.result.set_value(saved);
+        job.image.release();
+    }
+}
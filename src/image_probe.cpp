@@ -0,0 +1,202 @@
+#include "image_probe.h"
+#include "utils.h"
+#include <cstring>
+
+namespace {
+    uint32_t readBigEndian32(const unsigned char* p) {
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+               (static_cast<uint32_t>(p[2]) << 8) | p[3];
+    }
+
+    uint32_t readLittleEndian32(const unsigned char* p) {
+        return p[0] | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+               (static_cast<uint32_t>(p[3]) << 24);
+    }
+}
+
+ImageProbe ImageProbe::probe(const std::string& path) {
+    // Mapping the file means only the header pages are ever read from disk
+    Utils::MappedFile file(path);
+    if (!file.isOpen()) {
+        ImageProbe result;
+        return result;
+    }
+    return probe(file.data(), file.size());
+}
+
+ImageProbe ImageProbe::probe(const unsigned char* data, size_t length) {
+    ImageProbe result;
+    if (!data || length < 12) return result;
+
+    try {
+        if (data[0] == 0xFF && data[1] == 0xD8) {
+            result.format = FORMAT_JPEG;
+            result.valid = parseJpeg(data, length, result);
+        } else if (length >= 8 && std::memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0) {
+            result.format = FORMAT_PNG;
+            result.valid = parsePng(data, length, result);
+        } else if (std::memcmp(data, "RIFF", 4) == 0 && std::memcmp(data + 8, "WEBP", 4) == 0) {
+            result.format = FORMAT_WEBP;
+            result.valid = parseWebP(data, length, result);
+        } else if (std::memcmp(data, "II*\0", 4) == 0 || std::memcmp(data, "MM\0*", 4) == 0) {
+            result.format = FORMAT_TIFF;
+            result.valid = parseTiff(data, length, result, false);
+        }
+    } catch (const std::exception& e) {
+        Utils::logError("Exception probing image header: ", e.what());
+        result.valid = false;
+    }
+
+    if (result.valid && (result.width <= 0 || result.height <= 0)) {
+        result.valid = false;
+    }
+    return result;
+}
+
+cv::Size ImageProbe::orientedSize() const {
+    // Orientations 5-8 transpose the stored image
+    return orientation >= 5 ? cv::Size(height, width) : cv::Size(width, height);
+}
+
+bool ImageProbe::parseJpeg(const unsigned char* data, size_t length, ImageProbe& result) {
+    auto readWord = [data](size_t offset) { return (data[offset] << 8) | data[offset + 1]; };
+
+    // Walk marker segments until a start-of-frame; the scan data is never read
+    size_t pos = 2;
+    while (pos + 4 <= length) {
+        if (data[pos] != 0xFF) return false;
+
+        int marker = data[++pos];
+        while (marker == 0xFF && pos + 1 < length) marker = data[++pos];  // fill bytes
+        ++pos;
+        if (marker == 0xD9 || marker == 0xDA) return false;
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) continue;  // no payload
+
+        if (pos + 2 > length) return false;
+        size_t segmentLength = readWord(pos);
+        if (segmentLength < 2 || pos + segmentLength > length) return false;
+
+        // APP1 "Exif\0\0" wraps a TIFF header carrying the orientation tag
+        if (marker == 0xE1 && segmentLength >= 16 && std::memcmp(data + pos + 2, "Exif\0\0", 6) == 0) {
+            ImageProbe exif;
+            if (parseTiff(data + pos + 8, segmentLength - 8, exif, true)) {
+                result.orientation = exif.orientation;
+            }
+        }
+
+        // SOF0-SOF15, excluding DHT (C4), JPG (C8) and DAC (CC)
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (segmentLength < 8) return false;
+            result.bitDepth = data[pos + 2];
+            result.height = readWord(pos + 3);
+            result.width = readWord(pos + 5);
+            result.channels = data[pos + 7];
+            return true;
+        }
+
+        pos += segmentLength;
+    }
+
+    return false;
+}
+
+bool ImageProbe::parsePng(const unsigned char* data, size_t length, ImageProbe& result) {
+    // IHDR is always the first chunk: width, height, bit depth, colour type
+    if (length < 29 || std::memcmp(data + 12, "IHDR", 4) != 0) return false;
+
+    result.width = static_cast<int>(readBigEndian32(data + 16));
+    result.height = static_cast<int>(readBigEndian32(data + 20));
+    result.bitDepth = data[24];
+
+    switch (data[25]) {
+        case 0: result.channels = 1; break;  // gray
+        case 2: result.channels = 3; break;  // RGB
+        case 3: result.channels = 3; break;  // palette
+        case 4: result.channels = 2; break;  // gray + alpha
+        case 6: result.channels = 4; break;  // RGBA
+        default: return false;
+    }
+    return true;
+}
+
+bool ImageProbe::parseWebP(const unsigned char* data, size_t length, ImageProbe& result) {
+    if (length < 30) return false;
+    result.bitDepth = 8;
+
+    if (std::memcmp(data + 12, "VP8 ", 4) == 0) {
+        // Lossy: 3-byte frame tag, start code 9d 01 2a, then 14-bit dimensions
+        if (data[23] != 0x9D || data[24] != 0x01 || data[25] != 0x2A) return false;
+        result.width = (data[26] | (data[27] << 8)) & 0x3FFF;
+        result.height = (data[28] | (data[29] << 8)) & 0x3FFF;
+        result.channels = 3;
+        return true;
+    }
+
+    if (std::memcmp(data + 12, "VP8L", 4) == 0) {
+        // Lossless: signature 0x2f, then width-1 and height-1 in 14 bits each and an alpha hint
+        if (data[20] != 0x2F) return false;
+        uint32_t bits = readLittleEndian32(data + 21);
+        result.width = static_cast<int>((bits & 0x3FFF) + 1);
+        result.height = static_cast<int>(((bits >> 14) & 0x3FFF) + 1);
+        result.channels = (bits >> 28) & 1 ? 4 : 3;
+        return true;
+    }
+
+    if (std::memcmp(data + 12, "VP8X", 4) == 0) {
+        // Extended: flags, then 24-bit canvas width-1 and height-1
+        result.width = static_cast<int>((data[24] | (data[25] << 8) | (data[26] << 16)) + 1);
+        result.height = static_cast<int>((data[27] | (data[28] << 8) | (data[29] << 16)) + 1);
+        result.channels = (data[20] & 0x10) ? 4 : 3;
+        return true;
+    }
+
+    return false;
+}
+
+bool ImageProbe::parseTiff(const unsigned char* data, size_t length, ImageProbe& result, bool orientationOnly) {
+    if (length < 8) return false;
+
+    bool littleEndian = data[0] == 'I';
+    auto read16 = [&](size_t offset) -> uint32_t {
+        return littleEndian ? (data[offset] | (data[offset + 1] << 8)) : ((data[offset] << 8) | data[offset + 1]);
+    };
+    auto read32 = [&](size_t offset) -> uint32_t {
+        return littleEndian ? readLittleEndian32(data + offset) : readBigEndian32(data + offset);
+    };
+
+    // Only IFD0 is read; SHORT (3) and LONG (4) values up to 4 bytes sit inline
+    size_t ifd = read32(4);
+    if (ifd + 2 > length) return false;
+
+    uint32_t entryCount = read16(ifd);
+    result.channels = 1;
+    result.bitDepth = 1;
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        size_t entry = ifd + 2 + static_cast<size_t>(i) * 12;
+        if (entry + 12 > length) return false;
+
+        uint32_t tag = read16(entry);
+        uint32_t type = read16(entry + 2);
+        uint32_t count = read32(entry + 4);
+        uint32_t value = type == 3 ? read16(entry + 8) : read32(entry + 8);
+
+        switch (tag) {
+            case 256: result.width = static_cast<int>(value); break;
+            case 257: result.height = static_cast<int>(value); break;
+            case 258:
+                // More than two SHORTs don't fit inline; the first one lives at the offset
+                if (type == 3 && count > 2) {
+                    size_t offset = read32(entry + 8);
+                    if (offset + 2 > length) return false;
+                    value = read16(offset);
+                }
+                result.bitDepth = static_cast<int>(value);
+                break;
+            case 274: result.orientation = (value >= 1 && value <= 8) ? static_cast<int>(value) : 1; break;
+            case 277: result.channels = static_cast<int>(value); break;
+            default: break;
+        }
+    }
+
+    return orientationOnly || (result.width > 0 && result.height > 0);
+}
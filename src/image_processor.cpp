@@ -1,10 +1,14 @@
 #include "image_processor.h"
+#include "image_probe.h"
+#include "image_stats.h"
+#include "ssim_engine.h"
 #include "utils.h"
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
 #include <iostream>
 #include <filesystem>
+#include <limits>
 #include <algorithm>
 
 // Initialize static member
@@ -12,61 +16,145 @@ std::vector<std::string> ImageProcessor::supportedFormats_ = {
     ".jpg", ".jpeg", ".png", ".bmp", ".tiff", ".tif", ".webp", ".jp2"
 };
 
-cv::Mat ImageProcessor::loadImage(const std::string& path) {
+std::vector<std::string> ImageProcessor::supportedVideoFormats_ = {
+    ".mp4", ".avi", ".mov", ".mkv", ".m4v"
+};
+
+cv::Mat ImageProcessor::loadImage(const std::string& path, int minLongSide) {
     try {
-        cv::Mat image = cv::imread(path, cv::IMREAD_COLOR);
+        // JPEG DCT scaling decodes straight to the reduced size; other formats decode in full
+        int reduction = 1;
+        if (minLongSide > 0) {
+            ImageProbe header = ImageProbe::probe(path);
+            if (header.valid && header.format == ImageProbe::FORMAT_JPEG) {
+                reduction = selectDecodeReduction(header.orientedSize(), minLongSide);
+            }
+        }
+        
+        cv::Mat image = cv::imread(path, reducedReadFlags(reduction));
         
         if (image.empty()) {
-            Utils::logError("Failed to load image: " + path);
+            Utils::logError("Failed to load image: ", path);
             return cv::Mat();
         }
         
-        Utils::logDebug("Loaded image: " + path + " (" + std::to_string(image.cols) + "x" + 
-                       std::to_string(image.rows) + ", " + std::to_string(image.channels()) + " channels)");
+        Utils::logDebug("Loaded image: ", path, " (", image.cols, "x", image.rows, ", ", image.channels(),
+                        " channels", (reduction > 1 ? ", decoded at 1/" + std::to_string(reduction) : std::string()),
+                        ")");
         
         return image;
     } catch (const std::exception& e) {
-        Utils::logError("Exception loading image " + path + ": " + e.what());
+        Utils::logError("Exception loading image ", path, ": ", e.what());
         return cv::Mat();
     }
 }
 
-bool ImageProcessor::saveImage(const cv::Mat& image, const std::string& path, int quality) {
-    if (image.empty()) {
-        Utils::logError("Cannot save empty image to: " + path);
-        return false;
+cv::Mat ImageProcessor::loadImageMapped(const std::string& path, int minLongSide) {
+    try {
+        Utils::MappedFile file(path);
+        if (!file.isOpen()) {
+            Utils::logWarning("Memory mapping unavailable for ", path, ", falling back to imread");
+            return loadImage(path, minLongSide);
+        }
+        return decodeImage(file.data(), file.size(), path, minLongSide);
+    } catch (const std::exception& e) {
+        Utils::logError("Exception loading mapped image ", path, ": ", e.what());
+        return cv::Mat();
     }
+}
 
+cv::Mat ImageProcessor::decodeImage(const unsigned char* data, size_t size, const std::string& path, int minLongSide) {
     try {
-        std::vector<int> compressionParams;
-        std::string ext = Utils::toLowerCase(Utils::getFileExtension(path));
+        if (size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            Utils::logWarning("Encoded image too large to decode from memory, falling back to imread: ", path);
+            return loadImage(path, minLongSide);
+        }
         
-        if (ext == ".jpg" || ext == ".jpeg") {
-            compressionParams.push_back(cv::IMWRITE_JPEG_QUALITY);
-            compressionParams.push_back(quality);
-        } else if (ext == ".png") {
-            compressionParams.push_back(cv::IMWRITE_PNG_COMPRESSION);
-            compressionParams.push_back(9 - (quality / 11)); // Convert to PNG compression level
-        } else if (ext == ".webp") {
-            compressionParams.push_back(cv::IMWRITE_WEBP_QUALITY);
-            compressionParams.push_back(quality);
+        int reduction = 1;
+        if (minLongSide > 0) {
+            ImageProbe header = ImageProbe::probe(data, size);
+            if (header.valid && header.format == ImageProbe::FORMAT_JPEG) {
+                reduction = selectDecodeReduction(header.orientedSize(), minLongSide);
+            }
+        }
+        
+        // Non-owning header over the caller's bytes; imdecode reads them directly
+        cv::Mat encoded(1, static_cast<int>(size), CV_8UC1, const_cast<unsigned char*>(data));
+        cv::Mat image = cv::imdecode(encoded, reducedReadFlags(reduction));
+        
+        if (image.empty()) {
+            Utils::logError("Failed to decode image: ", path);
+            return cv::Mat();
         }
+        
+        Utils::logDebug("Loaded mapped image: ", path, " (", image.cols, "x", image.rows, ", ", image.channels(),
+                        " channels", (reduction > 1 ? ", decoded at 1/" + std::to_string(reduction) : std::string()),
+                        ")");
+        
+        return image;
+    } catch (const std::exception& e) {
+        Utils::logError("Exception decoding image ", path, ": ", e.what());
+        return cv::Mat();
+    }
+}
+
+bool ImageProcessor::saveImage(const cv::Mat& image, const std::string& path, int quality, EncodePreset preset) {
+    if (image.empty()) {
+        Utils::logError("Cannot save empty image to: ", path);
+        return false;
+    }
+
+    try {
+        std::vector<int> compressionParams = getEncodeParams(path, quality, preset);
 
         bool result = cv::imwrite(path, image, compressionParams);
         
         if (result) {
-            Utils::logDebug("Saved image: " + path);
+            Utils::logDebug("Saved image: ", path);
         } else {
-            Utils::logError("Failed to save image: " + path);
+            Utils::logError("Failed to save image: ", path);
         }
         
         return result;
     } catch (const std::exception& e) {
-        Utils::logError("Exception saving image " + path + ": " + e.what());
+        Utils::logError("Exception saving image ", path, ": ", e.what());
         return false;
     }
 }
 
+std::vector<int> ImageProcessor::getEncodeParams(const std::string& path, int quality, EncodePreset preset) {
+    std::vector<int> params;
+    std::string ext = Utils::toLowerCase(Utils::getFileExtension(path));
+    
+    if (ext == ".jpg" || ext == ".jpeg") {
+        params.push_back(cv::IMWRITE_JPEG_QUALITY);
+        params.push_back(quality);
+        if (preset == ENCODE_SMALL) {
+            params.push_back(cv::IMWRITE_JPEG_OPTIMIZE);
+            params.push_back(1);
+            params.push_back(cv::IMWRITE_JPEG_PROGRESSIVE);
+            params.push_back(1);
+        }
+    } else if (ext == ".png") {
+        // PNG cost is almost all deflate; RLE is near-free and still compresses flat regions
+        params.push_back(cv::IMWRITE_PNG_COMPRESSION);
+        if (preset == ENCODE_FAST) {
+            params.push_back(1);
+            params.push_back(cv::IMWRITE_PNG_STRATEGY);
+            params.push_back(cv::IMWRITE_PNG_STRATEGY_RLE);
+        } else if (preset == ENCODE_SMALL) {
+            params.push_back(9);
+        } else {
+            params.push_back(9 - (quality / 11)); // Convert to PNG compression level
+        }
+    } else if (ext == ".webp") {
+        params.push_back(cv::IMWRITE_WEBP_QUALITY);
+        params.push_back(quality);
+    }
+    
+    return params;
+}
+
 cv::Mat ImageProcessor::resizeImage(const cv::Mat& image, int width, int height, int interpolation) {
     if (image.empty()) {
         Utils::logError("Cannot resize empty image");
@@ -78,7 +166,7 @@ cv::Mat ImageProcessor::resizeImage(const cv::Mat& image, int width, int height,
         cv::resize(image, resized, cv::Size(width, height), 0, 0, interpolation);
         return resized;
     } catch (const std::exception& e) {
-        Utils::logError("Exception resizing image: " + std::string(e.what()));
+        Utils::logError("Exception resizing image: ", e.what());
         return cv::Mat();
     }
 }
@@ -94,12 +182,18 @@ cv::Mat ImageProcessor::resizeImageProportional(const cv::Mat& image, double sca
         cv::resize(image, resized, cv::Size(), scaleFactor, scaleFactor, interpolation);
         return resized;
     } catch (const std::exception& e) {
-        Utils::logError("Exception resizing image proportionally: " + std::string(e.what()));
+        Utils::logError("Exception resizing image proportionally: ", e.what());
         return cv::Mat();
     }
 }
 
 cv::Mat ImageProcessor::cropImage(const cv::Mat& image, const cv::Rect& roi) {
+    cv::Mat view = cropView(image, roi);
+    detach(view);
+    return view;
+}
+
+cv::Mat ImageProcessor::cropView(const cv::Mat& image, const cv::Rect& roi) {
     if (image.empty()) {
         Utils::logError("Cannot crop empty image");
         return cv::Mat();
@@ -114,75 +208,63 @@ cv::Mat ImageProcessor::cropImage(const cv::Mat& image, const cv::Rect& roi) {
             return cv::Mat();
         }
 
-        return image(safeRoi).clone();
+        // The header points into the parent buffer; no pixels are copied
+        return image(safeRoi);
     } catch (const std::exception& e) {
-        Utils::logError("Exception cropping image: " + std::string(e.what()));
+        Utils::logError("Exception cropping image: ", e.what());
         return cv::Mat();
     }
 }
 
-double ImageProcessor::calculateSharpness(const cv::Mat& image) {
-    if (image.empty()) return 0.0;
-
-    try {
-        cv::Mat gray;
-        if (image.channels() > 1) {
-            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-        } else {
-            gray = image.clone();
+int ImageProcessor::selectDecodeReduction(const cv::Size& imageSize, int minLongSide) {
+    if (minLongSide <= 0) return 1;
+    
+    // libjpeg rounds scaled dimensions up, so 1/n of a side is ceil(side / n)
+    int longSide = std::max(imageSize.width, imageSize.height);
+    for (int reduction : {8, 4, 2}) {
+        if ((longSide + reduction - 1) / reduction >= minLongSide) {
+            return reduction;
         }
-
-        cv::Mat laplacian;
-        cv::Laplacian(gray, laplacian, CV_64F);
-        
-        cv::Scalar mean, stddev;
-        cv::meanStdDev(laplacian, mean, stddev);
-        
-        return stddev.val[0] * stddev.val[0]; // Variance of Laplacian
-    } catch (const std::exception& e) {
-        Utils::logError("Exception calculating sharpness: " + std::string(e.what()));
-        return 0.0;
     }
+    
+    return 1;
 }
 
-double ImageProcessor::calculateContrast(const cv::Mat& image) {
-    if (image.empty()) return 0.0;
+int ImageProcessor::reducedReadFlags(int reduction) {
+    switch (reduction) {
+        case 8: return cv::IMREAD_REDUCED_COLOR_8;
+        case 4: return cv::IMREAD_REDUCED_COLOR_4;
+        case 2: return cv::IMREAD_REDUCED_COLOR_2;
+        default: return cv::IMREAD_COLOR;
+    }
+}
 
-    try {
-        cv::Mat gray;
-        if (image.channels() > 1) {
-            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-        } else {
-            gray = image.clone();
-        }
+bool ImageProcessor::isShared(const cv::Mat& image) {
+    if (image.empty()) return false;
+    
+    // Submatrices alias their parent; external data (u == nullptr) is never owned
+    return image.isSubmatrix() || !image.u || image.u->refcount > 1;
+}
 
-        cv::Scalar mean, stddev;
-        cv::meanStdDev(gray, mean, stddev);
-        
-        return stddev.val[0]; // Standard deviation as contrast measure
-    } catch (const std::exception& e) {
-        Utils::logError("Exception calculating contrast: " + std::string(e.what()));
-        return 0.0;
+void ImageProcessor::detach(cv::Mat& image) {
+    if (isShared(image)) {
+        image = image.clone();
     }
 }
 
-double ImageProcessor::calculateBrightness(const cv::Mat& image) {
+double ImageProcessor::calculateSharpness(const cv::Mat& image) {
     if (image.empty()) return 0.0;
+    return ImageStats::compute(image).sharpness; // Variance of Laplacian
+}
 
-    try {
-        cv::Mat gray;
-        if (image.channels() > 1) {
-            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-        } else {
-            gray = image.clone();
-        }
+double ImageProcessor::calculateContrast(const cv::Mat& image) {
+    if (image.empty()) return 0.0;
+    return ImageStats::compute(image).contrast; // Standard deviation as contrast measure
+}
 
-        cv::Scalar mean = cv::mean(gray);
-        return mean.val[0];
-    } catch (const std::exception& e) {
-        Utils::logError("Exception calculating brightness: " + std::string(e.what()));
-        return 0.0;
-    }
+double ImageProcessor::calculateBrightness(const cv::Mat& image) {
+    if (image.empty()) return 0.0;
+    return ImageStats::compute(image).brightness;
 }
 
 double ImageProcessor::calculatePSNR(const cv::Mat& original, const cv::Mat& enhanced) {
@@ -202,57 +284,34 @@ double ImageProcessor::calculatePSNR(const cv::Mat& original, const cv::Mat& enh
         
         return 10.0 * log10((255.0 * 255.0) / mseValue);
     } catch (const std::exception& e) {
-        Utils::logError("Exception calculating PSNR: " + std::string(e.what()));
+        Utils::logError("Exception calculating PSNR: ", e.what());
         return 0.0;
     }
 }
 
 double ImageProcessor::calculateSSIM(const cv::Mat& original, const cv::Mat& enhanced) {
-    if (original.empty() || enhanced.empty()) return 0.0;
-    if (original.size() != enhanced.size()) return 0.0;
+    // Luma SSIM with the reference 11x11 Gaussian window, streamed in parallel bands
+    return SSIMEngine::ssim(original, enhanced);
+}
 
-    try {
-        cv::Mat img1, img2;
-        original.convertTo(img1, CV_32F);
-        enhanced.convertTo(img2, CV_32F);
-
-        cv::Mat img1_sq, img2_sq, img1_img2;
-        cv::multiply(img1, img1, img1_sq);
-        cv::multiply(img2, img2, img2_sq);
-        cv::multiply(img1, img2, img1_img2);
-
-        cv::Mat mu1, mu2;
-        cv::GaussianBlur(img1, mu1, cv::Size(11, 11), 1.5);
-        cv::GaussianBlur(img2, mu2, cv::Size(11, 11), 1.5);
-
-        cv::Mat mu1_sq, mu2_sq, mu1_mu2;
-        cv::multiply(mu1, mu1, mu1_sq);
-        cv::multiply(mu2, mu2, mu2_sq);
-        cv::multiply(mu1, mu2, mu1_mu2);
-
-        cv::Mat sigma1_sq, sigma2_sq, sigma12;
-        cv::GaussianBlur(img1_sq, sigma1_sq, cv::Size(11, 11), 1.5);
-        cv::GaussianBlur(img2_sq, sigma2_sq, cv::Size(11, 11), 1.5);
-        cv::GaussianBlur(img1_img2, sigma12, cv::Size(11, 11), 1.5);
-
-        sigma1_sq -= mu1_sq;
-        sigma2_sq -= mu2_sq;
-        sigma12 -= mu1_mu2;
-
-        const double C1 = 6.5025, C2 = 58.5225;
-        cv::Mat numerator1 = 2 * mu1_mu2 + C1;
-        cv::Mat numerator2 = 2 * sigma12 + C2;
-        cv::Mat denominator1 = mu1_sq + mu2_sq + C1;
-        cv::Mat denominator2 = sigma1_sq + sigma2_sq + C2;
-
-        cv::Mat ssim_map;
-        cv::divide(numerator1.mul(numerator2), denominator1.mul(denominator2), ssim_map);
-
-        cv::Scalar ssim_mean = cv::mean(ssim_map);
-        return (ssim_mean.val[0] + ssim_mean.val[1] + ssim_mean.val[2]) / 3.0;
-    } catch (const std::exception& e) {
-        Utils::logError("Exception calculating SSIM: " + std::string(e.what()));
-        return 0.0;
+void ImageProcessor::alignForComparison(const cv::Mat& original, const cv::Mat& enhanced,
+                                        cv::Mat& reference, cv::Mat& result, int proxySide) {
+    // Compare on the output's grid: super resolution or a size cap would otherwise make PSNR/SSIM undefined
+    reference = original;
+    if (reference.size() != enhanced.size()) {
+        int interpolation = reference.cols < enhanced.cols ? cv::INTER_CUBIC : cv::INTER_AREA;
+        cv::resize(original, reference, enhanced.size(), 0, 0, interpolation);
+    }
+    if (reference.type() != enhanced.type()) {
+        reference.convertTo(reference, enhanced.type());
+    }
+    
+    result = enhanced;
+    int longSide = std::max(result.cols, result.rows);
+    if (proxySide > 0 && longSide > proxySide) {
+        double scale = static_cast<double>(proxySide) / longSide;
+        cv::resize(reference, reference, cv::Size(), scale, scale, cv::INTER_AREA);
+        cv::resize(enhanced, result, reference.size(), 0, 0, cv::INTER_AREA);
     }
 }
 
@@ -264,12 +323,17 @@ bool ImageProcessor::isValidImageFile(const std::string& filename) {
     return isFormatSupported(getImageFormat(filename));
 }
 
+bool ImageProcessor::isValidVideoFile(const std::string& filename) {
+    std::string ext = getImageFormat(filename);
+    return std::find(supportedVideoFormats_.begin(), supportedVideoFormats_.end(), ext) != supportedVideoFormats_.end();
+}
+
 std::vector<std::string> ImageProcessor::getImagesInDirectory(const std::string& directory) {
     std::vector<std::string> imageFiles;
     
     try {
         if (!Utils::directoryExists(directory)) {
-            Utils::logError("Directory does not exist: " + directory);
+            Utils::logError("Directory does not exist: ", directory);
             return imageFiles;
         }
 
@@ -280,7 +344,7 @@ std::vector<std::string> ImageProcessor::getImagesInDirectory(const std::string&
             }
         }
     } catch (const std::exception& e) {
-        Utils::logError("Exception listing images in directory: " + std::string(e.what()));
+        Utils::logError("Exception listing images in directory: ", e.what());
     }
     
     return imageFiles;
@@ -298,7 +362,7 @@ cv::Mat ImageProcessor::convertToGrayscale(const cv::Mat& image) {
         }
         return gray;
     } catch (const std::exception& e) {
-        Utils::logError("Exception converting to grayscale: " + std::string(e.what()));
+        Utils::logError("Exception converting to grayscale: ", e.what());
         return cv::Mat();
     }
 }
@@ -315,7 +379,7 @@ cv::Mat ImageProcessor::convertToRGB(const cv::Mat& image) {
         }
         return rgb;
     } catch (const std::exception& e) {
-        Utils::logError("Exception converting to RGB: " + std::string(e.what()));
+        Utils::logError("Exception converting to RGB: ", e.what());
         return cv::Mat();
     }
 }
@@ -328,7 +392,7 @@ cv::Mat ImageProcessor::normalizeImage(const cv::Mat& image) {
         cv::normalize(image, normalized, 0, 255, cv::NORM_MINMAX, CV_8U);
         return normalized;
     } catch (const std::exception& e) {
-        Utils::logError("Exception normalizing image: " + std::string(e.what()));
+        Utils::logError("Exception normalizing image: ", e.what());
         return cv::Mat();
     }
 }
@@ -348,7 +412,7 @@ void ImageProcessor::displayImage(const cv::Mat& image, const std::string& windo
             cv::destroyWindow(windowName);
         }
     } catch (const std::exception& e) {
-        Utils::logError("Exception displaying image: " + std::string(e.what()));
+        Utils::logError("Exception displaying image: ", e.what());
     }
 }
 
@@ -382,7 +446,7 @@ void ImageProcessor::showImageComparison(const cv::Mat& original, const cv::Mat&
         
         displayImage(comparison, title);
     } catch (const std::exception& e) {
-        Utils::logError("Exception showing image comparison: " + std::string(e.what()));
+        Utils::logError("Exception showing image comparison: ", e.what());
     }
 }
 
@@ -0,0 +1,167 @@
+#include "image_stats.h"
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+ImageStats ImageStats::compute(const cv::Mat& image) {
+    ImageStats stats;
+    if (image.empty()) return stats;
+
+    try {
+        cv::Mat source = image;
+        if (source.depth() != CV_8U) {
+            image.convertTo(source, CV_8U, eightBitScale(image.depth()));
+        }
+
+        const int channels = source.channels();
+        if (channels != 1 && channels != 3 && channels != 4) {
+            Utils::logError("Image statistics need 1, 3 or 4 channels, got ", channels);
+            return stats;
+        }
+
+        const int width = source.cols;
+        const int height = source.rows;
+
+        // Reflect-101 border, matching cv::Laplacian's default
+        auto reflect = [](int i, int n) {
+            if (n == 1) return 0;
+            return i < 0 ? -i : (i >= n ? 2 * n - 2 - i : i);
+        };
+
+        // Gray rows live in a three-slot ring, each converted once as the window slides down
+        std::vector<uchar> ring(static_cast<size_t>(3) * width);
+        int loadedRow[3] = {-1, -1, -1};
+        auto grayRow = [&](int y) {
+            int slot = y % 3;
+            uchar* dst = ring.data() + static_cast<size_t>(slot) * width;
+            if (loadedRow[slot] != y) {
+                if (channels == 1) {
+                    std::copy(source.ptr<uchar>(y), source.ptr<uchar>(y) + width, dst);
+                } else {
+                    convertRowToGray(source.ptr<uchar>(y), dst, width, channels);
+                }
+                loadedRow[slot] = y;
+            }
+            return static_cast<const uchar*>(dst);
+        };
+
+        // Four interleaved sub-histograms avoid stalls on runs of equal values
+        std::vector<uint32_t> subHistograms(4 * 256, 0);
+        int64_t laplacianSum = 0;
+        int64_t laplacianSumSq = 0;
+
+        for (int y = 0; y < height; ++y) {
+            const uchar* row = grayRow(y);
+            const uchar* up = grayRow(reflect(y - 1, height));
+            const uchar* down = grayRow(reflect(y + 1, height));
+
+            accumulateLaplacianRow(up, row, down, width, laplacianSum, laplacianSumSq);
+
+            int x = 0;
+            for (; x + 3 < width; x += 4) {
+                subHistograms[row[x]]++;
+                subHistograms[256 + row[x + 1]]++;
+                subHistograms[512 + row[x + 2]]++;
+                subHistograms[768 + row[x + 3]]++;
+            }
+            for (; x < width; ++x) {
+                subHistograms[row[x]]++;
+            }
+        }
+
+        // Brightness and contrast follow from the histogram without another pass
+        const double count = static_cast<double>(width) * height;
+        uint64_t levelSum = 0;
+        uint64_t levelSumSq = 0;
+        uint64_t shadows = 0;
+        uint64_t highlights = 0;
+        for (int level = 0; level < 256; ++level) {
+            uint32_t n = subHistograms[level] + subHistograms[256 + level] +
+                         subHistograms[512 + level] + subHistograms[768 + level];
+            stats.histogram[level] = n;
+            levelSum += static_cast<uint64_t>(level) * n;
+            levelSumSq += static_cast<uint64_t>(level) * level * n;
+            if (level <= SHADOW_CLIP_LEVEL) shadows += n;
+            if (level >= HIGHLIGHT_CLIP_LEVEL) highlights += n;
+        }
+
+        stats.pixelCount = static_cast<size_t>(width) * height;
+        stats.brightness = levelSum / count;
+        stats.contrast = std::sqrt(std::max(0.0, levelSumSq / count - stats.brightness * stats.brightness));
+        stats.shadowClipRatio = shadows / count;
+        stats.highlightClipRatio = highlights / count;
+
+        double laplacianMean = laplacianSum / count;
+        stats.sharpness = std::max(0.0, laplacianSumSq / count - laplacianMean * laplacianMean);
+
+    } catch (const std::exception& e) {
+        Utils::logError("Exception computing image statistics: ", e.what());
+    }
+
+    return stats;
+}
+
+ImageStats ImageStats::compute(const cv::Mat& image, const cv::Rect& roi) {
+    if (image.empty()) return ImageStats();
+
+    cv::Rect safeRoi = roi & cv::Rect(0, 0, image.cols, image.rows);
+    if (safeRoi.area() == 0) return ImageStats();
+
+    // The ROI header shares the parent buffer; rows are read through its step
+    return compute(image(safeRoi));
+}
+
+double ImageStats::eightBitScale(int depth) {
+    switch (depth) {
+        case CV_16U:
+        case CV_16S:
+            return 1.0 / 257.0;  // 65535 -> 255
+        case CV_16F:
+        case CV_32F:
+        case CV_64F:
+            return 255.0;        // normalised [0, 1] -> [0, 255]
+        default:
+            return 1.0;
+    }
+}
+
+void ImageStats::convertRowToGray(const uchar* src, uchar* dst, int width, int channels) {
+    // Same fixed-point BT.601 weights as cv::cvtColor(COLOR_BGR2GRAY) for 8-bit input
+    const int blueWeight = 1868, greenWeight = 9617, redWeight = 4899;
+    const int roundShift = 14;
+    const int roundDelta = 1 << (roundShift - 1);
+
+    for (int x = 0; x < width; ++x) {
+        const uchar* pixel = src + x * channels;
+        dst[x] = static_cast<uchar>((pixel[0] * blueWeight + pixel[1] * greenWeight + pixel[2] * redWeight + roundDelta) >> roundShift);
+    }
+}
+
+void ImageStats::accumulateLaplacianRow(const uchar* up, const uchar* row, const uchar* down, int width,
+                                        int64_t& sum, int64_t& sumSq) {
+    if (width == 1) {
+        int value = up[0] + down[0] - 2 * row[0];
+        sum += value;
+        sumSq += value * value;
+        return;
+    }
+
+    // Border columns reflect to x = 1 and x = width - 2
+    int first = up[0] + down[0] + 2 * row[1] - 4 * row[0];
+    int last = up[width - 1] + down[width - 1] + 2 * row[width - 2] - 4 * row[width - 1];
+    int64_t rowSum = first + last;
+    int64_t rowSumSq = static_cast<int64_t>(first) * first + static_cast<int64_t>(last) * last;
+
+    // Branch-free integer body so the compiler can vectorise it
+    int64_t bodySum = 0;
+    int64_t bodySumSq = 0;
+    for (int x = 1; x < width - 1; ++x) {
+        int32_t value = up[x] + down[x] + row[x - 1] + row[x + 1] - 4 * row[x];
+        bodySum += value;
+        bodySumSq += value * value;
+    }
+
+    sum += rowSum + bodySum;
+    sumSq += rowSumSq + bodySumSq;
+}
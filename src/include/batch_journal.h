@@ -0,0 +1,53 @@
+#ifndef BATCH_JOURNAL_H
+#define BATCH_JOURNAL_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Append-only record of completed batch inputs.
+ * Each line holds input path, size, mtime, content hash, parameter hash and
+ * output path, flushed as soon as the output is saved, so a rerun after a
+ * crash (or a nightly run over a growing archive) only processes new or
+ * changed inputs. Later lines for the same input supersede earlier ones.
+ */
+class BatchJournal {
+public:
+    struct Entry {
+        uintmax_t size = 0;
+        int64_t mtime = 0;
+        uint64_t contentHash = 0;
+        uint64_t paramsHash = 0;
+        std::string outputPath;
+    };
+
+    explicit BatchJournal(const std::string& path);
+
+    // Loads existing entries and opens the journal for appending
+    bool open();
+
+    // Metadata match is enough; a size match with a new mtime falls back to the content hash
+    bool isUpToDate(const std::string& inputPath, const std::string& outputPath, uint64_t paramsHash);
+    // contentHash is hashBytes over the input as it was decoded, so the file is not read again
+    bool record(const std::string& inputPath, const std::string& outputPath, uint64_t paramsHash, uint64_t contentHash);
+
+    size_t size() const { return entries_.size(); }
+    const std::string& getPath() const { return path_; }
+
+    // 64-bit FNV-1a
+    static uint64_t hashBytes(const void* data, size_t length, uint64_t seed = 14695981039346656037ULL);
+    static bool hashFile(const std::string& path, uint64_t& hash);
+
+private:
+    std::string path_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::ofstream out_;
+
+    static bool statFile(const std::string& path, uintmax_t& size, int64_t& mtime);
+    void writeEntry(std::ostream& stream, const std::string& inputPath, const Entry& entry);
+    bool compact();
+};
+
+#endif // BATCH_JOURNAL_H
@@ -0,0 +1,89 @@
+#ifndef BATCH_SOURCE_H
+#define BATCH_SOURCE_H
+
+#include "image_probe.h"
+#include "utils.h"
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+
+/**
+ * Streaming batch input.
+ * Enumerates a directory (flat or recursive) or a manifest file on a
+ * background thread and hands items out as they are found, so work starts
+ * before enumeration ends. Directory outputs mirror the input tree; an
+ * output directory inside (or equal to) the input is kept out of the walk.
+ *
+ * Manifest lines are tab-separated: input path, optional output path and
+ * optional per-image overrides as key=value pairs separated by ';'.
+ * Relative inputs resolve against the manifest's directory, relative
+ * outputs against the output directory. Lines starting with '#' are skipped.
+ *
+ * With probing on, image headers are read during enumeration: corrupt and
+ * undersized images never reach the queue. Consumers that work on several
+ * items at once can ask for each window to be handed out largest-first so
+ * big images don't straggle at the end; a sequential consumer gains
+ * nothing from it and keeps discovery order.
+ */
+class BatchSource {
+public:
+    enum Mode {
+        FLAT_DIRECTORY,
+        RECURSIVE_DIRECTORY,
+        MANIFEST
+    };
+
+    struct Item {
+        std::string inputPath;
+        std::string outputPath;
+        std::string name;  // input path relative to the batch root, for logs
+        std::map<std::string, std::string> overrides;
+        ImageProbe probe;  // header info when probing is on; FORMAT_UNKNOWN otherwise
+    };
+
+    struct Options {
+        bool probeHeaders = true;
+        int minWidth = 64;         // smaller images are rejected before decode
+        int minHeight = 64;
+        size_t sortWindow = 1;     // >1 reorders each window by pixel count, for parallel consumers only
+        size_t queueDepth = 256;
+    };
+
+    BatchSource(Mode mode, const std::string& input, const std::string& outputDir,
+                std::function<bool(const std::string&)> accept, const Options& options);
+    ~BatchSource();
+    BatchSource(const BatchSource&) = delete;
+    BatchSource& operator=(const BatchSource&) = delete;
+
+    // Blocks until the next item is found; false once enumeration is exhausted
+    bool next(Item& item);
+
+    size_t getDiscoveredCount() const { return discovered_.load(); }
+    size_t getRejectedCount() const { return rejected_.load(); }
+
+    static const std::string kOutputPrefix;  // directory outputs are named prefix + input file name
+
+private:
+    Mode mode_;
+    std::filesystem::path input_;
+    std::filesystem::path outputDir_;
+    std::function<bool(const std::string&)> accept_;
+    Options options_;
+    Utils::BoundedQueue<Item> items_;
+    std::atomic<size_t> discovered_;
+    std::atomic<size_t> rejected_;
+    std::vector<Item> window_;
+    std::thread enumerator_;
+
+    void enumerateDirectory(bool recursive);
+    void enumerateManifest();
+    bool parseManifestLine(const std::string& line, Item& item) const;
+    std::string mirroredOutputPath(const std::filesystem::path& relative) const;
+    bool enqueue(Item item);
+    bool flushWindow();
+};
+
+#endif // BATCH_SOURCE_H
@@ -44,6 +44,12 @@ public:
     static cv::Mat skinSmoothing(const cv::Mat& image, const std::vector<cv::Rect>& faceRegions, double strength = 0.5);
     static cv::Mat bilateralSkinSmoothing(const cv::Mat& image, const cv::Mat& mask, int kernelSize = 15);
     
+    // Facial feature regions (eyes with brows, mouth) from 68-point landmarks
+    static cv::Mat createFeatureMask(const cv::Size& imageSize, const std::vector<std::vector<cv::Point2f>>& faceLandmarks, int margin = 6);
+    // Interior of each landmarked face minus its features: cheeks and skin that only need smoothing
+    static cv::Mat createSmoothOnlyMask(const cv::Size& imageSize, const std::vector<cv::Rect>& faces,
+                                        const std::vector<std::vector<cv::Point2f>>& faceLandmarks, int margin = 6);
+    
     // Advanced deblurring algorithms
     static cv::Mat wienerDeconvolution(const cv::Mat& image, const cv::Mat& psf, double nsr = 0.01);
     static cv::Mat richardsonLucyDeconvolution(const cv::Mat& image, const cv::Mat& psf, int iterations = 20);
@@ -63,6 +69,7 @@ private:
     static cv::Mat cropPaddedImage(const cv::Mat& image, const cv::Size& originalSize);
     static std::vector<cv::Mat> splitChannels(const cv::Mat& image);
     static cv::Mat mergeChannels(const std::vector<cv::Mat>& channels);
+    static std::vector<std::vector<cv::Point>> featureHulls(const std::vector<cv::Point2f>& landmarks);
 };
 
 #endif // ENHANCEMENT_ALGORITHMS_H
\ No newline at end of file
@@ -4,9 +4,15 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/objdetect.hpp>
 #include <opencv2/dnn.hpp>
+#ifdef HAVE_OPENCV_FACE
+#include <opencv2/face.hpp>  // opencv_contrib; without it landmark detection is unavailable
+#endif
+#include <mutex>
 #include <string>
 #include <vector>
 
+class ImageStats;
+
 /**
  * Face detection utilities using multiple methods
  */
@@ -19,6 +25,22 @@ public:
         LBP_CASCADE
     };
 
+    enum OverlapMetric {
+        OVERLAP_IOU,     // intersection over union
+        OVERLAP_IOMIN    // intersection over the smaller box
+    };
+
+    struct NMSParams {
+        double overlapThreshold = 0.3;
+        OverlapMetric metric = OVERLAP_IOMIN;
+        
+        // Soft-NMS decays neighbour scores by exp(-overlap^2 / sigma) instead of dropping
+        // them; a box is discarded once its score falls below minScore of its original
+        bool softNMS = false;
+        double softSigma = 0.5;
+        double minScore = 0.05;
+    };
+
     FaceDetector();
     ~FaceDetector();
 
@@ -26,24 +48,34 @@ public:
     bool initializeHaarCascade(const std::string& cascadePath = "");
     bool initializeLBPCascade(const std::string& cascadePath = "");
     bool initializeDNNDetector(const std::string& modelPath = "", const std::string& configPath = "");
+    bool initializeLandmarkDetector(const std::string& modelPath = "");
 
     // Face detection methods
     std::vector<cv::Rect> detectFaces(const cv::Mat& image, DetectionMethod method = CASCADE_CLASSIFIER);
     std::vector<cv::Rect> detectFacesHaar(const cv::Mat& image, double scaleFactor = 1.1, int minNeighbors = 3);
     std::vector<cv::Rect> detectFacesLBP(const cv::Mat& image, double scaleFactor = 1.1, int minNeighbors = 3);
     std::vector<cv::Rect> detectFacesDNN(const cv::Mat& image, float confidenceThreshold = 0.5);
+    std::vector<std::vector<cv::Rect>> detectFacesDNNBatch(const std::vector<cv::Mat>& images, float confidenceThreshold = 0.5);
 
-    // Face landmark detection
+    // Face landmark detection (68-point LBF model)
     std::vector<cv::Point2f> detectFaceLandmarks(const cv::Mat& image, const cv::Rect& faceRect);
+    std::vector<std::vector<cv::Point2f>> detectAllFaceLandmarks(const cv::Mat& image, const std::vector<cv::Rect>& faceRects);
+    bool hasLandmarkDetector() const { return landmarkInitialized_; }
+    bool hasDNNDetector() const { return dnnInitialized_; }
 
-    // Utility functions
+    // Utility functions (extract* return owned copies, *View(s) share the parent buffer)
     cv::Mat extractFaceRegion(const cv::Mat& image, const cv::Rect& faceRect, int padding = 20);
     std::vector<cv::Mat> extractAllFaces(const cv::Mat& image, const std::vector<cv::Rect>& faceRects);
+    cv::Mat faceRegionView(const cv::Mat& image, const cv::Rect& faceRect, int padding = 20);
+    std::vector<cv::Mat> faceRegionViews(const cv::Mat& image, const std::vector<cv::Rect>& faceRects, int padding = 20);
     
-    // Face quality assessment
+    // Face quality assessment (the ImageStats overloads reuse one statistics pass)
     double assessFaceQuality(const cv::Mat& faceImage);
     bool isFaceBlurred(const cv::Mat& faceImage, double threshold = 100.0);
     bool isFaceWellLit(const cv::Mat& faceImage, double minBrightness = 50.0, double maxBrightness = 200.0);
+    double assessFaceQuality(const ImageStats& stats);
+    bool isFaceBlurred(const ImageStats& stats, double threshold = 100.0);
+    bool isFaceWellLit(const ImageStats& stats, double minBrightness = 50.0, double maxBrightness = 200.0);
 
     // Visualization
     cv::Mat drawFaceBoxes(const cv::Mat& image, const std::vector<cv::Rect>& faces);
@@ -54,27 +86,52 @@ public:
     void setMaxFaceSize(const cv::Size& maxSize) { maxFaceSize_ = maxSize; }
     cv::Size getMinFaceSize() const { return minFaceSize_; }
     cv::Size getMaxFaceSize() const { return maxFaceSize_; }
+    void setNMSParams(const NMSParams& params) { nmsParams_ = params; }
+    NMSParams getNMSParams() const { return nmsParams_; }
+    void setDNNBatchSize(int batchSize);
+    int getDNNBatchSize() const { return dnnBatchSize_; }
 
 private:
     cv::CascadeClassifier haarCascade_;
     cv::CascadeClassifier lbpCascade_;
     cv::dnn::Net dnnNet_;
+#ifdef HAVE_OPENCV_FACE
+    // FacemarkLBF::fit keeps per-call state, so every concurrent fit borrows its own instance.
+    // The first is loaded up front; extra ones load the model on first use and are kept
+    std::vector<cv::Ptr<cv::face::Facemark>> idleFacemarks_;
+    std::mutex facemarkMutex_;
+    std::string landmarkModelPath_;
+
+    cv::Ptr<cv::face::Facemark> acquireFacemark();
+    void releaseFacemark(const cv::Ptr<cv::face::Facemark>& facemark);
+#endif
     
     cv::Size minFaceSize_;
     cv::Size maxFaceSize_;
+    NMSParams nmsParams_;
+    
+    // DNN batching: the input blob is sized for a full batch once and reused
+    int dnnBatchSize_;
+    cv::Size dnnInputSize_;
+    cv::Mat dnnBlob_;
     
     bool haarInitialized_;
     bool lbpInitialized_;
     bool dnnInitialized_;
+    bool landmarkInitialized_;
 
     // Helper functions
-    std::vector<cv::Rect> filterOverlappingRects(const std::vector<cv::Rect>& rects, double overlapThreshold = 0.3);
+    std::vector<cv::Rect> filterOverlappingRects(const std::vector<cv::Rect>& rects);
+    std::vector<cv::Rect> filterOverlappingRects(const std::vector<cv::Rect>& rects, const std::vector<float>& scores);
+    static std::vector<float> cascadeConfidences(const std::vector<double>& levelWeights);
     cv::Rect expandRect(const cv::Rect& rect, const cv::Size& imageSize, int padding);
     std::string getDefaultCascadePath(const std::string& cascadeType);
     
     // DNN preprocessing
     cv::Mat preprocessForDNN(const cv::Mat& image, const cv::Size& inputSize = cv::Size(300, 300));
+    cv::Mat preprocessForDNN(const std::vector<cv::Mat>& images);
     std::vector<cv::Rect> postprocessDNNResults(const cv::Mat& detections, const cv::Size& imageSize, float confidenceThreshold);
+    std::vector<std::vector<cv::Rect>> postprocessDNNResults(const cv::Mat& detections, const std::vector<cv::Size>& imageSizes, float confidenceThreshold);
 };
 
 #endif // FACE_DETECTOR_H
\ No newline at end of file
@@ -5,9 +5,17 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/objdetect.hpp>
 #include <opencv2/photo.hpp>
+#include "image_processor.h"
+#include "batch_source.h"
 #include <string>
+#include <iosfwd>
 #include <vector>
 #include <memory>
+#include <map>
+#include <array>
+#include <cstdint>
+
+class FaceDetector;
 
 /**
  * Face Enhancement Pipeline
@@ -15,6 +23,19 @@
  */
 class FaceEnhancer {
 public:
+    enum PipelineRoute {
+        ROUTE_SKIP,   // already acceptable: no enhancement stages
+        ROUTE_LIGHT,  // sharpening and tone only
+        ROUTE_FULL    // every stage
+    };
+
+    struct RoutingDecision {
+        PipelineRoute route = ROUTE_FULL;
+        double imageQuality = 0.0;
+        double minFaceQuality = 0.0;
+        double timeSavedMs = 0.0;  // skipped stages at their measured cost, minus routing time
+    };
+
     struct EnhancementParams {
         // Sharpening parameters
         double sharpenStrength = 1.5;
@@ -28,6 +49,33 @@ public:
         // Super resolution parameters
         int srScale = 2;
         
+        // Output size cap; JPEG inputs are decoded at reduced scale when the cap allows it (0 = no cap)
+        int maxOutputSide = 0;
+        
+        // Input I/O: decode from an mmap of the file, and hint readahead for upcoming batch files
+        bool memoryMappedInput = false;
+        int readaheadFiles = 2;
+        
+        // Output encoding; batch saves run on a separate encoder pool of encoderThreads
+        int outputQuality = 95;
+        ImageProcessor::EncodePreset encodePreset = ImageProcessor::ENCODE_DEFAULT;
+        int encoderThreads = 2;
+        
+        // Batch input: walk subdirectories too
+        bool recursiveBatch = false;
+        
+        // Resumable batches: skip inputs the journal records as done with the same parameters
+        bool resumeBatch = false;
+        std::string journalPath;  // empty = .face_enhancer_journal in the output directory
+        
+        // Batch prefiltering from image headers: reject corrupt/tiny inputs and decode JPEGs above
+        // maxInputPixels at reduced size without super resolution; other formats above it are skipped
+        bool probeBatchInputs = true;
+        size_t maxInputPixels = 40000000;
+        
+        // Quality metrics are evaluated on a proxy with this longest side (0 = output resolution)
+        int metricsProxySide = 0;
+        
         // Edge enhancement
         double edgeEnhancementStrength = 0.8;
         
@@ -42,6 +90,43 @@ public:
         bool useHistogramEqualization = true;
         bool useCLAHE = true;
         double claheClipLimit = 2.0;
+        
+        // Landmark-guided detail: with an LBF model loaded, sharpening and edge enhancement
+        // skip the inside of each face except eyes and mouth, leaving cheeks to smoothing
+        std::string landmarkModelPath;
+        bool landmarkGuidedDetail = true;
+        
+        // SSD face detector (TensorFlow .pb and .pbtxt) instead of the Haar cascade;
+        // batch mode decodes dnnBatchSize images and detects them in one forward pass
+        std::string dnnModelPath;
+        std::string dnnConfigPath;
+        int dnnBatchSize = 8;
+        float dnnConfidence = 0.5f;
+        
+        // Quality-gated routing: score image and faces up front and skip stages they don't need
+        bool adaptiveRouting = false;
+        double skipQualityThreshold = 0.75;
+        double lightQualityThreshold = 0.5;
+    };
+
+    struct QualityMetrics {
+        bool computed = false;
+        double psnr = 0.0;
+        double ssim = 0.0;
+        double msssim = 0.0;
+        double sharpnessOriginal = 0.0;
+        double sharpnessEnhanced = 0.0;
+        cv::Size evaluatedSize;  // resolution the metrics were computed at
+        double timeMs = 0.0;
+    };
+
+    struct VideoParams {
+        int detectionInterval = 10;       // full face detection every N frames
+        double sceneCutThreshold = 0.4;   // histogram distance that forces re-detection
+        double trackingMinScore = 0.6;    // template match score below which a face is lost
+        size_t queueDepth = 8;            // frames buffered between decode, enhance and encode
+        int temporalWindow = 5;           // frames stacked for temporal denoising, 1 falls back to per-frame NLM
+        bool temporalNLM = false;         // multi-frame NLM over the stack instead of the motion-compensated mean
     };
 
     FaceEnhancer();
@@ -49,23 +134,75 @@ public:
 
     // Main processing function
     bool enhanceImage(const std::string& inputPath, const std::string& outputPath);
+    // Also fills metrics from the in-memory original and result while the output is encoded
+    bool enhanceImage(const std::string& inputPath, const std::string& outputPath, QualityMetrics* metrics);
     bool enhanceImage(const cv::Mat& inputImage, cv::Mat& outputImage);
     
-    // Batch processing
+    // Batch processing; outputs mirror the input tree under outputDir
     bool enhanceBatch(const std::string& inputDir, const std::string& outputDir);
+    bool enhanceManifest(const std::string& manifestPath, const std::string& outputDir);
+    
+    // Video processing
+    bool enhanceVideo(const std::string& inputPath, const std::string& outputPath);
+    
+    // Streaming: each message is a 4-byte little-endian length followed by an encoded image.
+    // Replies come back in order in the same framing; a zero-length reply marks a failed image.
+    bool enhanceStream(std::istream& input, std::ostream& output, const std::string& outputFormat = "");
     
     // Parameter configuration
     void setEnhancementParams(const EnhancementParams& params);
     EnhancementParams getEnhancementParams() const;
+    void setVideoParams(const VideoParams& params) { videoParams_ = params; }
+    VideoParams getVideoParams() const { return videoParams_; }
     
     // Utility functions
     bool isValidImageFormat(const std::string& filename) const;
     std::vector<std::string> getSupportedFormats() const;
+    RoutingDecision getLastRoutingDecision() const { return lastRouting_; }
+    // Stage name and milliseconds for each stage the last pipeline run executed, in order
+    const std::vector<std::pair<std::string, double>>& getLastStageTimes() const { return lastStageTimes_; }
+    // Most Mat bytes the last pipeline run held at once; 0 unless MemoryTracker is installed
+    size_t getLastPeakMatBytes() const { return lastPeakMatBytes_; }
+    static std::string getRouteName(PipelineRoute route);
+    static QualityMetrics computeQualityMetrics(const cv::Mat& original, const cv::Mat& enhanced, int proxySide = 0);
+    uint64_t getParamsHash() const;  // fingerprint of the output-affecting parameters
+    // Sets one parameter by its command-line name (sharpen, denoise, ...); false for unknown keys or bad values
+    static bool applyParamOverride(EnhancementParams& params, const std::string& key, const std::string& value);
 
 private:
     EnhancementParams params_;
+    VideoParams videoParams_;
     cv::CascadeClassifier faceCascade_;
+    std::unique_ptr<FaceDetector> faceDetector_;
     std::unique_ptr<cv::dnn::Net> srNet_;
+    RoutingDecision lastRouting_;
+    std::map<std::string, double> stageCostPerMegapixel_;
+    std::vector<std::pair<std::string, double>> lastStageTimes_;
+    size_t lastPeakMatBytes_ = 0;
+    
+    // Batch driver shared by directory and manifest input
+    bool runBatch(BatchSource& source, const std::string& inputName, const std::string& outputDir);
+    // Decode at the size the pipeline needs (see maxOutputSide, maxInputPixels); empty on failure.
+    // With contentHash the file is read once for both the hash and the decode
+    cv::Mat loadInput(const std::string& inputPath, int maxInputSide, uint64_t* contentHash = nullptr);
+    // Faces the caller already has, and where they came from
+    struct KnownFaces {
+        const std::vector<cv::Rect>* faces = nullptr;  // null: the pipeline detects them itself
+        bool tracked = false;      // carried over by the video tracker rather than found by a detector
+        double detectionMs = 0.0;  // this image's share of the caller's detection or tracking time
+    };
+
+    // Pipeline plus output cap; known faces skip detection
+    bool enhanceDecoded(const cv::Mat& inputImage, cv::Mat& outputImage, const KnownFaces& knownFaces);
+    BatchSource::Options getBatchSourceOptions() const;
+    
+    // Load, enhance and cap to maxOutputSide; saving is left to the caller
+    bool enhanceFile(const std::string& inputPath, cv::Mat& outputImage, int maxInputSide = 0, cv::Mat* loadedInput = nullptr);
+    void applyOutputCap(cv::Mat& image) const;
+    
+    // Pipeline with faces supplied by the caller, or detected when there are none; pre-denoised input skips spatial NLM
+    bool runPipeline(const cv::Mat& inputImage, cv::Mat& outputImage, const KnownFaces& knownFaces,
+                     bool preDenoised = false);
     
     // Core enhancement algorithms
     cv::Mat sharpenImage(const cv::Mat& image);
@@ -75,10 +212,27 @@ private:
     cv::Mat enhanceHistogram(const cv::Mat& image);
     cv::Mat smoothSkin(const cv::Mat& image, const std::vector<cv::Rect>& faces);
     cv::Mat superResolution(const cv::Mat& image);
+    // Full-frame passes that leave smoothOnlyMask pixels as they were
+    cv::Mat sharpenOutside(const cv::Mat& image, const cv::Mat& smoothOnlyMask);
+    cv::Mat enhanceEdgesOutside(const cv::Mat& image, const cv::Mat& smoothOnlyMask);
     
     // Face detection
     std::vector<cv::Rect> detectFaces(const cv::Mat& image);
     
+    // Quality routing
+    RoutingDecision routePipeline(const cv::Mat& image, const std::vector<cv::Rect>& faces);
+    void recordStageCost(const std::string& step, double processingTime, double megapixels);
+    double estimateSkippedTime(PipelineRoute route, bool hasFaces, double megapixels) const;
+    
+    // Video helpers
+    bool isSceneCut(const cv::Mat& frame, std::array<uint32_t, 256>& previousHistogram, bool& hasPrevious);
+    
+    // Stream helpers; a length prefix above the cap is treated as a corrupt stream
+    static const uint32_t kMaxStreamMessageBytes = 256u << 20;
+    static bool readStreamMessage(std::istream& input, std::vector<uchar>& bytes);
+    static bool writeStreamMessage(std::ostream& output, const std::vector<uchar>& bytes);
+    static std::string detectStreamFormat(const std::vector<uchar>& bytes);
+    
     // Helper functions
     bool initializeFaceDetector();
     bool initializeSuperResolution();
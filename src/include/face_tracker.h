@@ -0,0 +1,37 @@
+#ifndef FACE_TRACKER_H
+#define FACE_TRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/imgproc.hpp>
+#include <vector>
+
+/**
+ * Cheap frame-to-frame face tracking by template matching.
+ * Seeded from detector rects, each face is searched for in a window
+ * around its last position; faces whose match falls below the score
+ * threshold are dropped so the caller can re-detect.
+ */
+class FaceTracker {
+public:
+    explicit FaceTracker(double minScore = 0.6, double searchMargin = 0.5);
+
+    void reset(const cv::Mat& frame, const std::vector<cv::Rect>& faces);
+    std::vector<cv::Rect> track(const cv::Mat& frame);
+
+    bool empty() const { return tracks_.empty(); }
+    size_t size() const { return tracks_.size(); }
+
+private:
+    struct Track {
+        cv::Rect rect;
+        cv::Mat templ;
+    };
+
+    std::vector<Track> tracks_;
+    double minScore_;
+    double searchMargin_;  // search window grows by this fraction of the face size per side
+
+    static cv::Mat toGray(const cv::Mat& frame);
+};
+
+#endif // FACE_TRACKER_H
@@ -0,0 +1,47 @@
+#ifndef IMAGE_ENCODER_H
+#define IMAGE_ENCODER_H
+
+#include "image_processor.h"
+#include "utils.h"
+#include <opencv2/opencv.hpp>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Encoder thread pool for asynchronous saves.
+ * Runs on its own thread budget so slow encodes (PNG, WebP) overlap with
+ * enhancement of the next image; the bounded job queue caps how many
+ * finished images wait in memory.
+ */
+class ImageEncoder {
+public:
+    explicit ImageEncoder(int threads = 2, size_t queueDepth = 8);
+    ~ImageEncoder();
+    ImageEncoder(const ImageEncoder&) = delete;
+    ImageEncoder& operator=(const ImageEncoder&) = delete;
+
+    // The image is shared, not copied; callers must not write to it afterwards
+    std::future<bool> saveAsync(const cv::Mat& image, const std::string& path, int quality = 95,
+                                ImageProcessor::EncodePreset preset = ImageProcessor::ENCODE_DEFAULT);
+    void shutdown();
+
+    int getThreadCount() const { return static_cast<int>(workers_.size()); }
+
+private:
+    struct Job {
+        cv::Mat image;
+        std::string path;
+        int quality = 95;
+        ImageProcessor::EncodePreset preset = ImageProcessor::ENCODE_DEFAULT;
+        std::promise<bool> result;
+    };
+
+    Utils::BoundedQueue<Job> jobs_;
+    std::vector<std::thread> workers_;
+
+    void workerLoop();
+};
+
+#endif // IMAGE_ENCODER_H
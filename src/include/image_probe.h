@@ -0,0 +1,47 @@
+#ifndef IMAGE_PROBE_H
+#define IMAGE_PROBE_H
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <string>
+
+/**
+ * Header-only image inspection.
+ * Reads dimensions, channels, bit depth and EXIF orientation for JPEG, PNG,
+ * WebP and TIFF without decoding any pixel data, so batch inputs can be
+ * filtered and ordered before decode time is spent on them.
+ */
+class ImageProbe {
+public:
+    enum Format {
+        FORMAT_UNKNOWN,  // not one of the probed containers; decode will decide
+        FORMAT_JPEG,
+        FORMAT_PNG,
+        FORMAT_WEBP,
+        FORMAT_TIFF
+    };
+
+    Format format = FORMAT_UNKNOWN;
+    bool valid = false;    // header parsed; false with a known format means a corrupt header
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    int bitDepth = 0;
+    int orientation = 1;   // EXIF orientation, 1-8
+
+    static ImageProbe probe(const std::string& path);
+    static ImageProbe probe(const unsigned char* data, size_t length);
+
+    // Size after EXIF rotation, as cv::imread returns it
+    cv::Size orientedSize() const;
+    size_t pixelCount() const { return static_cast<size_t>(width) * height; }
+    bool isCorrupt() const { return format != FORMAT_UNKNOWN && !valid; }
+
+private:
+    static bool parseJpeg(const unsigned char* data, size_t length, ImageProbe& result);
+    static bool parsePng(const unsigned char* data, size_t length, ImageProbe& result);
+    static bool parseWebP(const unsigned char* data, size_t length, ImageProbe& result);
+    static bool parseTiff(const unsigned char* data, size_t length, ImageProbe& result, bool orientationOnly);
+};
+
+#endif // IMAGE_PROBE_H
@@ -11,14 +11,33 @@
  */
 class ImageProcessor {
 public:
+    // Encoder speed/size trade-off, applied per output format
+    enum EncodePreset {
+        ENCODE_DEFAULT,  // quality-derived settings
+        ENCODE_FAST,     // lowest encode time: light PNG deflate, no JPEG optimisation
+        ENCODE_SMALL     // smallest file: maximum PNG deflate, optimised progressive JPEG
+    };
+
     // Image I/O operations
-    static cv::Mat loadImage(const std::string& path);
-    static bool saveImage(const cv::Mat& image, const std::string& path, int quality = 95);
+    // A positive minLongSide lets JPEGs decode at 1/2, 1/4 or 1/8 scale while still covering it
+    static cv::Mat loadImage(const std::string& path, int minLongSide = 0);
+    // Same, but decodes straight from an mmap of the file instead of imread's buffered reads
+    static cv::Mat loadImageMapped(const std::string& path, int minLongSide = 0);
+    // Decodes encoded file bytes already in memory; path is only used in log messages
+    static cv::Mat decodeImage(const unsigned char* data, size_t size, const std::string& path, int minLongSide = 0);
+    static bool saveImage(const cv::Mat& image, const std::string& path, int quality = 95,
+                          EncodePreset preset = ENCODE_DEFAULT);
+    static std::vector<int> getEncodeParams(const std::string& path, int quality, EncodePreset preset = ENCODE_DEFAULT);
     
     // Basic image operations
     static cv::Mat resizeImage(const cv::Mat& image, int width, int height, int interpolation = cv::INTER_LANCZOS4);
     static cv::Mat resizeImageProportional(const cv::Mat& image, double scaleFactor, int interpolation = cv::INTER_LANCZOS4);
     static cv::Mat cropImage(const cv::Mat& image, const cv::Rect& roi);
+    static cv::Mat cropView(const cv::Mat& image, const cv::Rect& roi);
+    
+    // Copy-on-write: gives a view or shared Mat its own pixels before it is mutated
+    static bool isShared(const cv::Mat& image);
+    static void detach(cv::Mat& image);
     
     // Image quality assessment
     static double calculateSharpness(const cv::Mat& image);
@@ -26,11 +45,16 @@ public:
     static double calculateBrightness(const cv::Mat& image);
     static double calculatePSNR(const cv::Mat& original, const cv::Mat& enhanced);
     static double calculateSSIM(const cv::Mat& original, const cv::Mat& enhanced);
+    // Resamples original onto enhanced's grid and type, then both onto a proxy when proxySide > 0
+    static void alignForComparison(const cv::Mat& original, const cv::Mat& enhanced,
+                                   cv::Mat& reference, cv::Mat& result, int proxySide = 0);
     
     // Image format utilities
     static std::string getImageFormat(const std::string& filename);
     static bool isValidImageFile(const std::string& filename);
+    static bool isValidVideoFile(const std::string& filename);
     static std::vector<std::string> getImagesInDirectory(const std::string& directory);
+    static int selectDecodeReduction(const cv::Size& imageSize, int minLongSide);
     
     // Image conversion utilities
     static cv::Mat convertToGrayscale(const cv::Mat& image);
@@ -43,7 +67,9 @@ public:
     
 private:
     static std::vector<std::string> supportedFormats_;
+    static std::vector<std::string> supportedVideoFormats_;
     static bool isFormatSupported(const std::string& extension);
+    static int reducedReadFlags(int reduction);
 };
 
 #endif // IMAGE_PROCESSOR_H
\ No newline at end of file
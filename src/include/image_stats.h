@@ -0,0 +1,38 @@
+#ifndef IMAGE_STATS_H
+#define IMAGE_STATS_H
+
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <cstdint>
+
+/**
+ * Single-pass image statistics shared by quality metrics and face checks.
+ * Luma, Laplacian variance, histogram and clipping come from one walk over
+ * the pixels; an ROI is read in place through a view of the parent image.
+ */
+class ImageStats {
+public:
+    // Luma levels at or beyond these count as clipped
+    static constexpr int SHADOW_CLIP_LEVEL = 4;
+    static constexpr int HIGHLIGHT_CLIP_LEVEL = 251;
+
+    double sharpness = 0.0;           // variance of the 4-neighbour Laplacian
+    double brightness = 0.0;          // mean luma
+    double contrast = 0.0;            // luma standard deviation
+    double shadowClipRatio = 0.0;     // fraction of pixels <= SHADOW_CLIP_LEVEL
+    double highlightClipRatio = 0.0;  // fraction of pixels >= HIGHLIGHT_CLIP_LEVEL
+    std::array<uint32_t, 256> histogram{};
+    size_t pixelCount = 0;
+
+    // Other depths are measured on the 8-bit scale: 16-bit full range, floats in [0, 1]
+    static ImageStats compute(const cv::Mat& image);
+    static ImageStats compute(const cv::Mat& image, const cv::Rect& roi);
+
+private:
+    static double eightBitScale(int depth);
+    static void convertRowToGray(const uchar* src, uchar* dst, int width, int channels);
+    static void accumulateLaplacianRow(const uchar* up, const uchar* row, const uchar* down, int width,
+                                       int64_t& sum, int64_t& sumSq);
+};
+
+#endif // IMAGE_STATS_H
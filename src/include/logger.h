@@ -0,0 +1,96 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "utils.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Log sink behind Utils::log.
+ * Synchronous by default. In async mode records go into a bounded
+ * lock-free ring (per-slot sequence numbers, many producers, one consumer)
+ * and a background thread formats timestamps and writes them in batches,
+ * so workers never block on the stream. The writer sleeps on a condition
+ * variable while the ring is empty and producers only signal it when it
+ * is actually waiting. A full ring drops non-error records and reports
+ * how many were lost; errors wait for space.
+ */
+class Logger {
+public:
+    struct Record {
+        Utils::LogLevel level = Utils::LOG_INFO;
+        std::chrono::system_clock::time_point time;
+        std::string message;
+    };
+
+    static Logger& instance();
+
+    void submit(Utils::LogLevel level, std::string message);
+    void setStream(std::ostream& stream);
+    // Writes text as is, after whatever is already queued
+    void writeRaw(const std::string& text);
+    void setAsync(bool enabled);
+    bool isAsync() const { return running_.load(); }
+    // Blocks until every record submitted so far has been written
+    void flush();
+
+    // One message per key per interval; suppressed counts the ones skipped since the last
+    bool allowRateLimited(const std::string& key, size_t& suppressed);
+    void setRateLimitInterval(std::chrono::milliseconds interval);
+
+    size_t getDroppedCount() const { return dropped_.load(); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+
+    struct RateState {
+        std::chrono::steady_clock::time_point last;
+        size_t suppressed = 0;
+    };
+
+    static const size_t kCapacity = 8192;  // power of two
+
+    Logger();
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    std::vector<Slot> slots_;
+    std::atomic<size_t> enqueuePos_;
+    size_t dequeuePos_;  // consumer thread only
+    std::atomic<size_t> written_;
+    std::atomic<size_t> dropped_;
+    size_t droppedReported_;
+    std::atomic<bool> running_;
+    std::atomic<int> activeProducers_;  // submits that saw async mode and may still push
+    std::atomic<bool> waiting_;         // drain thread is (about to be) asleep
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;     // producers -> drain thread
+    std::condition_variable writtenCv_;  // drain thread -> flush()
+    std::thread drainThread_;
+    std::atomic<std::ostream*> stream_;
+    std::mutex writeMutex_;  // orders synchronous writes, and async batches against them
+
+    std::mutex rateMutex_;
+    std::unordered_map<std::string, RateState> rateStates_;
+    std::chrono::milliseconds rateInterval_;
+
+    bool tryPush(Record& record);
+    bool tryPop(Record& record);
+    void drainLoop();
+    bool hasPending() const;  // drain thread only
+    void wakeDrain();
+    void write(std::ostream& out, const Record& record);
+};
+
+#endif // LOGGER_H
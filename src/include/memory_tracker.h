@@ -0,0 +1,88 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * Counts cv::Mat memory.
+ * Once installed, every Mat buffer is allocated through a counting wrapper
+ * around OpenCV's standard allocator, which keeps live and peak bytes for
+ * the process, for each pipeline stage (whatever StageScope is open on the
+ * allocating thread), and for the image the current thread is working on.
+ * Each buffer remembers the stage and image it was charged to, so a free on
+ * another thread (an encoder, a consumer queue) credits the right owner.
+ * Not installed, StageScope and beginImage cost one relaxed load.
+ */
+class MemoryTracker {
+public:
+    struct StageStats {
+        std::string name;
+        size_t liveBytes = 0;        // allocated in this stage and not yet freed
+        size_t peakBytes = 0;        // high-water of liveBytes
+        size_t peakTotalBytes = 0;   // process-wide live bytes at the worst allocation in this stage
+        size_t allocatedBytes = 0;   // cumulative
+        size_t allocations = 0;
+    };
+
+    // Mats created before install keep the standard allocator; the tracker is never uninstalled
+    static void install();
+    static bool isInstalled();
+
+    static size_t getLiveBytes();
+    static size_t getPeakBytes();
+    static std::vector<StageStats> getStageStats();
+    // Peaks restart from the current live bytes, e.g. between benchmark levels
+    static void resetPeaks();
+    static void logSummary();
+
+    // A named stage, registered once; declare it static so StageScope takes no lock
+    class Stage {
+    public:
+        explicit Stage(const char* name);  // name must outlive the process, e.g. a literal
+        int index() const { return index_; }
+    private:
+        int index_;
+    };
+
+    // Attributes Mat allocations on this thread to a stage while in scope; scopes nest
+    class StageScope {
+    public:
+        explicit StageScope(const Stage& stage);
+        ~StageScope();
+        StageScope(const StageScope&) = delete;
+        StageScope& operator=(const StageScope&) = delete;
+    private:
+        int previous_;
+    };
+
+    // High-water of Mat bytes charged to the image this thread began, wherever they were freed
+    static void beginImage();
+    static size_t getImagePeakBytes();
+
+    struct ImageOwner;  // per-image counters, defined in memory_tracker.cpp
+
+    // What this thread's allocations are charged to. Capture it before cv::parallel_for_ and
+    // adopt it in the body, or worker allocations land in "Other" and no image
+    struct Context {
+        ImageOwner* image = nullptr;
+        int stage = 0;
+    };
+    static Context currentContext();
+
+    class ContextScope {
+    public:
+        explicit ContextScope(const Context& context);
+        ~ContextScope();
+        ContextScope(const ContextScope&) = delete;
+        ContextScope& operator=(const ContextScope&) = delete;
+    private:
+        Context previous_;
+    };
+
+private:
+    class CountingAllocator;
+};
+
+#endif // MEMORY_TRACKER_H
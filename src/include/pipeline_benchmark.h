@@ -0,0 +1,56 @@
+#ifndef PIPELINE_BENCHMARK_H
+#define PIPELINE_BENCHMARK_H
+
+#include "face_enhancer.h"
+#include "utils.h"
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * End-to-end throughput benchmark.
+ * Decodes a corpus once, then runs the full enhancement pipeline over it
+ * from several concurrent workers (one FaceEnhancer each), so disk and
+ * codecs are excluded. Reports throughput, latency percentiles, the mean
+ * per-stage breakdown and peak RSS for every concurrency level, plus
+ * Mat memory per image and per stage when MemoryTracker is installed.
+ */
+class PipelineBenchmark {
+public:
+    struct LevelResult {
+        int concurrency = 0;
+        size_t images = 0;
+        size_t failures = 0;
+        double wallMs = 0.0;
+        double imagesPerSecond = 0.0;
+        Utils::SampleStats latencyMs;
+        std::map<std::string, double> stageMeanMs;  // per image, over every image that ran the stage
+        size_t peakRssBytes = 0;                    // process high-water mark after this level
+        size_t peakMatBytes = 0;                    // most Mat bytes live at once during this level
+        Utils::SampleStats imagePeakMatBytes;       // per-image Mat high-water, i.e. what one worker needs
+        std::map<std::string, size_t> stagePeakMatBytes;  // process-wide Mat bytes at each stage's worst point
+    };
+
+    // Every concurrency level processes the corpus this many times after one warmup image per worker
+    PipelineBenchmark(const FaceEnhancer::EnhancementParams& params, int iterations = 3);
+
+    // A single image or every image in a directory; returns how many were decoded
+    size_t loadCorpus(const std::string& path);
+    bool run(const std::vector<int>& concurrencyLevels);
+    bool write(const std::string& path) const;  // JSON
+    void logSummary() const;
+
+    const std::vector<LevelResult>& getResults() const { return results_; }
+
+private:
+    FaceEnhancer::EnhancementParams params_;
+    int iterations_;
+    std::vector<cv::Mat> corpus_;
+    double corpusMegapixels_;
+    std::vector<LevelResult> results_;
+
+    LevelResult runLevel(int concurrency);
+};
+
+#endif // PIPELINE_BENCHMARK_H
@@ -0,0 +1,66 @@
+#ifndef QUALITY_REPORT_H
+#define QUALITY_REPORT_H
+
+#include "batch_source.h"
+#include "utils.h"
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * Batch quality report.
+ * Pairs each input with its enhanced output the same way batch runs name
+ * them, scores the pairs on a pool of workers and writes per-image metrics,
+ * per-stage timings and aggregate distributions as CSV or JSON.
+ */
+class QualityReport {
+public:
+    struct Entry {
+        std::string name;
+        std::string inputPath;
+        std::string outputPath;
+        bool ok = false;
+        std::string error;
+
+        cv::Size inputSize;   // as decoded, possibly at reduced JPEG scale
+        cv::Size outputSize;
+        double psnr = 0.0;
+        double ssim = 0.0;
+        double msssim = 0.0;
+        double sharpnessOriginal = 0.0;
+        double sharpnessEnhanced = 0.0;
+
+        // Per-stage timings in milliseconds
+        double decodeMs = 0.0;
+        double resampleMs = 0.0;
+        double psnrMs = 0.0;
+        double ssimMs = 0.0;
+        double sharpnessMs = 0.0;
+        double totalMs = 0.0;
+    };
+
+    // threads = 0 uses every hardware thread; proxySide > 0 scores on a downscaled proxy
+    explicit QualityReport(int threads = 0, int proxySide = 0);
+
+    // Scores every pair the source yields; false if none could be scored
+    bool run(BatchSource& source);
+    // Format follows the extension: .json, otherwise CSV (with a _summary.csv alongside)
+    bool write(const std::string& reportPath) const;
+    void logSummary() const;
+
+    static Entry evaluate(const BatchSource::Item& item, int proxySide = 0);
+
+    const std::vector<Entry>& getEntries() const { return entries_; }
+
+private:
+    int threads_;
+    int proxySide_;
+    std::vector<Entry> entries_;
+    double wallMs_;
+
+    std::vector<std::pair<std::string, Utils::SampleStats>> summarize() const;
+    bool writeCsv(const std::string& reportPath) const;
+    bool writeJson(const std::string& reportPath) const;
+};
+
+#endif // QUALITY_REPORT_H
@@ -0,0 +1,51 @@
+#ifndef SSIM_ENGINE_H
+#define SSIM_ENGINE_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * Structural similarity without full-resolution temporaries.
+ * Window moments are accumulated row by row with a separable (Gaussian)
+ * or running-sum (box) window, so each band only keeps a few rows of
+ * intermediates; bands are scored in parallel.
+ */
+class SSIMEngine {
+public:
+    enum Window {
+        GAUSSIAN,  // 11x11, sigma 1.5 by default, as in the reference SSIM
+        BOX        // uniform window updated with running sums
+    };
+
+    struct Options {
+        bool lumaOnly = true;  // score BT.601 luma; false averages the colour planes
+        Window window = GAUSSIAN;
+        int windowSize = 11;
+        double sigma = 1.5;    // Gaussian window only
+        int bandRows = 64;     // output rows per parallel work item
+    };
+
+    // Mean SSIM and mean contrast-structure term of one plane pair
+    struct Score {
+        double ssim = 0.0;
+        double cs = 0.0;
+    };
+
+    // All return 0 for empty or mismatched inputs
+    static double ssim(const cv::Mat& first, const cv::Mat& second);
+    static double ssim(const cv::Mat& first, const cv::Mat& second, const Options& options);
+    // Five-scale MS-SSIM; scales that no longer fit the window are dropped and the weights renormalised
+    static double msssim(const cv::Mat& first, const cv::Mat& second);
+    static double msssim(const cv::Mat& first, const cv::Mat& second, const Options& options);
+    // Area-weighted SSIM over regions such as detected faces, read in place through views
+    static double ssimInRegions(const cv::Mat& first, const cv::Mat& second, const std::vector<cv::Rect>& regions);
+    static double ssimInRegions(const cv::Mat& first, const cv::Mat& second, const std::vector<cv::Rect>& regions,
+                                const Options& options);
+
+private:
+    static std::vector<cv::Mat> preparePlanes(const cv::Mat& image, bool lumaOnly);
+    static std::vector<float> windowWeights(const Options& options);
+    static Score scorePlane(const cv::Mat& first, const cv::Mat& second, const Options& options);
+};
+
+#endif // SSIM_ENGINE_H
@@ -0,0 +1,46 @@
+#ifndef TEMPORAL_DENOISER_H
+#define TEMPORAL_DENOISER_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/photo.hpp>
+#include <deque>
+
+/**
+ * Multi-frame denoising for video.
+ * Keeps a ring buffer of recent frames, aligns them to the current frame
+ * with a global phase-correlation shift, and denoises from the aligned stack.
+ */
+class TemporalDenoiser {
+public:
+    enum Method {
+        MOTION_COMPENSATED_MEAN,  // per-pixel mean of aligned frames that agree with the current one
+        NLM_MULTI                 // fastNlMeansDenoising(Colored)Multi over the aligned stack
+    };
+
+    explicit TemporalDenoiser(int windowSize = 5, Method method = MOTION_COMPENSATED_MEAN, float strength = 10.0f);
+
+    // Returns false when no earlier frame could be aligned; output is then the input frame
+    bool denoise(const cv::Mat& frame, cv::Mat& output);
+    void reset();
+
+    size_t size() const { return frames_.size(); }
+
+private:
+    struct BufferedFrame {
+        cv::Mat image;
+        cv::Mat proxy;  // downscaled float luma for phase correlation
+    };
+
+    std::deque<BufferedFrame> frames_;
+    int windowSize_;
+    Method method_;
+    float strength_;
+    cv::Mat hanningWindow_;
+
+    cv::Mat makeProxy(const cv::Mat& frame, double& scale) const;
+    cv::Mat meanOfStack(const cv::Mat& frame, const std::vector<cv::Mat>& aligned) const;
+    cv::Mat nlmOfStack(const cv::Mat& frame, const std::vector<cv::Mat>& aligned) const;
+};
+
+#endif // TEMPORAL_DENOISER_H
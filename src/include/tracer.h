@@ -0,0 +1,73 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/**
+ * Opt-in timeline tracing.
+ * Spans (name, image ID, thread, start, duration) go into a buffer owned by
+ * the recording thread and are written as Chrome trace-event JSON, which
+ * chrome://tracing and Perfetto open, when the process exits. Until
+ * enable() is called every Span and ImageScope costs one relaxed load, so
+ * the instrumentation stays in release builds.
+ * The cv::parallel_for_ bodies this project owns (SSIM bands, landmark
+ * fitting) open "opencv" spans, so they appear on OpenCV's worker threads.
+ * Filters that parallelise inside OpenCV (denoising, bilateral, resize) are
+ * out of reach and show only as the calling stage's span.
+ */
+class Tracer {
+public:
+    // Records from now on; the trace is written to path at exit
+    static void enable(const std::string& path);
+    static bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+    // Writes everything recorded so far; enable() arranges for this to run at exit
+    static bool write();
+
+    // Label for this thread's row in the timeline, e.g. "batch worker 2"
+    static void setThreadName(const std::string& name);
+    // A span that ended just now, for work the caller already timed
+    static void recordCompleted(const std::string& name, double durationMs, const char* category = "stage");
+
+    // Times the enclosing scope
+    class Span {
+    public:
+        explicit Span(const char* name, const char* category = "stage")
+            : name_(name), category_(category), active_(isEnabled()) {
+            if (active_) start_ = std::chrono::steady_clock::now();
+        }
+        ~Span() {
+            if (active_) finish();
+        }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+    private:
+        const char* name_;
+        const char* category_;
+        bool active_;
+        std::chrono::steady_clock::time_point start_;
+
+        void finish();
+    };
+
+    // Tags spans recorded on this thread with an image ID until the scope ends
+    class ImageScope {
+    public:
+        explicit ImageScope(const std::string& image);
+        ~ImageScope();
+        ImageScope(const ImageScope&) = delete;
+        ImageScope& operator=(const ImageScope&) = delete;
+    private:
+        bool active_;
+        std::string previous_;
+    };
+
+private:
+    static std::atomic<bool> enabled_;
+
+    static void record(const std::string& name, const char* category,
+                       std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+};
+
+#endif // TRACER_H
@@ -3,8 +3,15 @@
 
 #include <opencv2/opencv.hpp>
 #include <string>
+#include <ostream>
+#include <sstream>
+#include <iomanip>
+#include <atomic>
 #include <vector>
 #include <chrono>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 
 /**
  * Utility functions for the Face Enhancer application
@@ -19,6 +26,7 @@ public:
     static std::string getFileExtension(const std::string& filename);
     static std::string getBasename(const std::string& path);
     static std::string joinPath(const std::string& path1, const std::string& path2);
+    static void prefetchFile(const std::string& path);  // readahead hint for a file needed soon
 
     // String utilities
     static std::string toLowerCase(const std::string& str);
@@ -27,22 +35,45 @@ public:
     static std::string trim(const std::string& str);
     static bool endsWith(const std::string& str, const std::string& suffix);
     static bool startsWith(const std::string& str, const std::string& prefix);
+    // Quoted and escaped as a JSON string literal
+    static std::string jsonString(const std::string& value);
 
     // Time and performance utilities
     static std::string getCurrentTimestamp();
+    static std::string formatTimestamp(const std::chrono::system_clock::time_point& time);
     static double getElapsedTime(const std::chrono::high_resolution_clock::time_point& start);
     static void printProcessingTime(const std::string& operation, double timeMs);
 
     // Image validation utilities
     static bool isImageFile(const std::string& filename);
     static bool isValidImageDimensions(const cv::Mat& image, int minWidth = 64, int minHeight = 64);
+    static bool isValidImageDimensions(const cv::Size& size, int minWidth = 64, int minHeight = 64);
     static std::string getImageInfo(const cv::Mat& image);
 
     // Memory and system utilities
-    static size_t getMemoryUsage();
+    static size_t getMemoryUsage();      // current resident set
+    static size_t getPeakMemoryUsage();  // resident high-water mark since start
     static std::string formatFileSize(size_t bytes);
     static void printSystemInfo();
 
+    // Read-only memory mapping of a whole file; the pages are read once, by whoever touches them
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool isOpen() const { return data_ != nullptr; }
+        const unsigned char* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        const unsigned char* data_;
+        size_t size_;
+        std::vector<unsigned char> buffer_;  // used where mmap is unavailable
+    };
+
     // Progress tracking
     class ProgressBar {
     public:
@@ -57,6 +88,63 @@ public:
         void printBar(int current);
     };
 
+    // Order statistics of a sample, e.g. per-image scores or timings
+    struct SampleStats {
+        size_t count = 0;
+        double mean = 0.0;
+        double stddev = 0.0;
+        double min = 0.0;
+        double p5 = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+
+        static SampleStats of(std::vector<double> values);
+    };
+
+    // Blocking producer/consumer queue for pipelined stages. close() wakes all
+    // waiters: push() then fails and pop() drains what is left before failing.
+    template <typename T>
+    class BoundedQueue {
+    public:
+        explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1), closed_(false) {}
+
+        bool push(T item) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            notFull_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+            if (closed_) return false;
+            items_.push_back(std::move(item));
+            notEmpty_.notify_one();
+            return true;
+        }
+
+        bool pop(T& item) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+            if (items_.empty()) return false;
+            item = std::move(items_.front());
+            items_.pop_front();
+            notFull_.notify_one();
+            return true;
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            notFull_.notify_all();
+            notEmpty_.notify_all();
+        }
+
+    private:
+        size_t capacity_;
+        bool closed_;
+        std::deque<T> items_;
+        std::mutex mutex_;
+        std::condition_variable notFull_;
+        std::condition_variable notEmpty_;
+    };
+
     // Configuration utilities
     struct Config {
         std::string inputPath;
@@ -67,6 +155,17 @@ public:
         double sharpenStrength;
         double noiseReduction;
         int superResolutionScale;
+        bool streamMode = false;    // length-prefixed images on stdin/stdout instead of files
+        std::string streamFormat;   // reply encoding, e.g. ".png"; empty keeps each input's format
+        std::string manifestPath;   // batch input listed in a file instead of a directory
+        std::string reportPath;     // score existing batch outputs into this CSV/JSON instead of enhancing
+        int reportThreads = 0;      // 0 = every hardware thread
+        bool benchmarkMode = false;          // time the in-memory pipeline instead of enhancing files
+        std::string benchmarkLevels = "1";   // comma-separated worker counts
+        int benchmarkIterations = 3;         // passes over the corpus per level
+        std::string benchmarkOutput;         // optional JSON results file
+        bool memoryStats = false;            // count Mat memory per stage and log it at the end
+        std::string tracePath;               // Chrome trace-event JSON written at exit; empty = no tracing
         
         static Config loadFromFile(const std::string& configPath);
         bool saveToFile(const std::string& configPath) const;
@@ -91,15 +190,55 @@ public:
     };
 
     static void setLogLevel(LogLevel level);
+    static void setLogStream(std::ostream& stream);  // e.g. std::cerr when stdout carries data
+    // Queue records for a background writer instead of writing on the caller's thread
+    static void setAsyncLogging(bool enabled);
+    static void flushLog();
+    // Unformatted text on the log stream, e.g. a progress bar redrawn in place
+    static void writeToLogStream(const std::string& text);
+    static void setLogRateLimit(int intervalMs);  // per-key interval for the *Limited variants
+    static bool isLogEnabled(LogLevel level) { return level >= currentLogLevel_.load(std::memory_order_relaxed); }
+    static std::string getLogLevelString(LogLevel level);
+
+    // Parts are only formatted when the level is enabled, e.g. logDebug("Step took ", ms, " ms")
     static void log(LogLevel level, const std::string& message);
-    static void logDebug(const std::string& message);
-    static void logInfo(const std::string& message);
-    static void logWarning(const std::string& message);
-    static void logError(const std::string& message);
+    template <typename... Parts> static void logDebug(const Parts&... parts) { logParts(LOG_DEBUG, parts...); }
+    template <typename... Parts> static void logInfo(const Parts&... parts) { logParts(LOG_INFO, parts...); }
+    template <typename... Parts> static void logWarning(const Parts&... parts) { logParts(LOG_WARNING, parts...); }
+    template <typename... Parts> static void logError(const Parts&... parts) { logParts(LOG_ERROR, parts...); }
+
+    // Per-image messages in batch runs: at most one per key per interval, with a count of those skipped
+    template <typename... Parts>
+    static void logLimited(LogLevel level, const std::string& key, const Parts&... parts) {
+        if (!isLogEnabled(level)) return;
+        size_t suppressed = 0;
+        if (!allowRateLimited(key, suppressed)) return;
+        std::string message = concat(parts...);
+        if (suppressed > 0) {
+            message += " (+" + std::to_string(suppressed) + " similar)";
+        }
+        log(level, message);
+    }
 
 private:
-    static LogLevel currentLogLevel_;
-    static std::string getLogLevelString(LogLevel level);
+    static std::atomic<LogLevel> currentLogLevel_;
+    static bool allowRateLimited(const std::string& key, size_t& suppressed);
+
+    template <typename... Parts>
+    static void logParts(LogLevel level, const Parts&... parts) {
+        if (isLogEnabled(level)) log(level, concat(parts...));
+    }
+
+    // Numbers format as std::to_string does, so log lines read the same either way
+    static const std::string& concat(const std::string& message) { return message; }
+    template <typename... Parts>
+    static std::string concat(const Parts&... parts) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(6);
+        (out << ... << parts);
+        return out.str();
+    }
+
     static std::vector<std::string> imageExtensions_;
 };
 
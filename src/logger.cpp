@@ -0,0 +1,238 @@
+#include "logger.h"
+#include <cstdint>
+#include <iostream>
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : slots_(kCapacity)
+    , enqueuePos_(0)
+    , dequeuePos_(0)
+    , written_(0)
+    , dropped_(0)
+    , droppedReported_(0)
+    , running_(false)
+    , activeProducers_(0)
+    , waiting_(false)
+    , stream_(&std::cout)
+    , rateInterval_(1000) {
+    for (size_t i = 0; i < kCapacity; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+Logger::~Logger() {
+    // Static destruction at exit: whatever is still queued gets written
+    setAsync(false);
+}
+
+void Logger::submit(Utils::LogLevel level, std::string message) {
+    Record record;
+    record.level = level;
+    record.time = std::chrono::system_clock::now();
+    record.message = std::move(message);
+
+    // setAsync(false) waits for activeProducers_ to reach zero before its last drain, so a
+    // record is either pushed before that drain or written synchronously below
+    activeProducers_.fetch_add(1);
+    if (running_.load()) {
+        bool queued = tryPush(record);
+        if (!queued && level != Utils::LOG_ERROR) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            activeProducers_.fetch_sub(1);
+            wakeDrain();
+            return;
+        }
+        // Errors are never dropped; wait for the drain thread to make room
+        while (!queued && running_.load()) {
+            std::this_thread::yield();
+            queued = tryPush(record);
+        }
+        if (queued) {
+            activeProducers_.fetch_sub(1);
+            wakeDrain();
+            return;
+        }
+    }
+    activeProducers_.fetch_sub(1);
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    std::ostream& out = *stream_.load();
+    write(out, record);
+    out.flush();
+}
+
+void Logger::setStream(std::ostream& stream) {
+    flush();
+    stream_.store(&stream);
+}
+
+void Logger::writeRaw(const std::string& text) {
+    flush();
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    std::ostream& out = *stream_.load();
+    out << text;
+    out.flush();
+}
+
+void Logger::setAsync(bool enabled) {
+    if (enabled == running_.load()) return;
+
+    if (enabled) {
+        running_.store(true, std::memory_order_release);
+        drainThread_ = std::thread(&Logger::drainLoop, this);
+    } else {
+        // New submits write synchronously from here on; wait out the ones already pushing
+        running_.store(false);
+        while (activeProducers_.load() != 0) {
+            std::this_thread::yield();
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+        }
+        wakeCv_.notify_all();
+        writtenCv_.notify_all();
+        if (drainThread_.joinable()) drainThread_.join();
+
+        // Whatever the drain thread left behind, written before any later synchronous record
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        std::ostream& out = *stream_.load();
+        Record record;
+        while (tryPop(record)) {
+            write(out, record);
+        }
+        written_.store(dequeuePos_, std::memory_order_release);
+        out.flush();
+    }
+}
+
+void Logger::flush() {
+    if (!running_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        stream_.load()->flush();
+        return;
+    }
+
+    // Every record queued before this point has been written once the drain thread passes it
+    const size_t target = enqueuePos_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    writtenCv_.wait(lock, [this, target]() {
+        return written_.load(std::memory_order_acquire) >= target || !running_.load();
+    });
+}
+
+bool Logger::allowRateLimited(const std::string& key, size_t& suppressed) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(rateMutex_);
+
+    auto it = rateStates_.find(key);
+    if (it == rateStates_.end()) {
+        rateStates_[key].last = now;
+        suppressed = 0;
+        return true;
+    }
+    if (now - it->second.last < rateInterval_) {
+        it->second.suppressed++;
+        return false;
+    }
+    suppressed = it->second.suppressed;
+    it->second.suppressed = 0;
+    it->second.last = now;
+    return true;
+}
+
+void Logger::setRateLimitInterval(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(rateMutex_);
+    rateInterval_ = interval;
+}
+
+bool Logger::tryPush(Record& record) {
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots_[pos & (kCapacity - 1)];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.record = std::move(record);
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  // full
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool Logger::hasPending() const {
+    const Slot& slot = slots_[dequeuePos_ & (kCapacity - 1)];
+    return slot.sequence.load(std::memory_order_acquire) == dequeuePos_ + 1 ||
+           dropped_.load(std::memory_order_relaxed) != droppedReported_;
+}
+
+void Logger::wakeDrain() {
+    // Pairs with the fence in drainLoop: either the drain thread sees the record or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!waiting_.load(std::memory_order_relaxed)) return;
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    wakeCv_.notify_one();
+}
+
+bool Logger::tryPop(Record& record) {
+    Slot& slot = slots_[dequeuePos_ & (kCapacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1) return false;
+
+    record = std::move(slot.record);
+    slot.sequence.store(dequeuePos_ + kCapacity, std::memory_order_release);
+    dequeuePos_++;
+    return true;
+}
+
+void Logger::drainLoop() {
+    Record record;
+    for (;;) {
+        bool stopping = !running_.load();
+        size_t batch = 0;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            std::ostream& out = *stream_.load();
+            while (tryPop(record)) {
+                write(out, record);
+                batch++;
+            }
+
+            size_t dropped = dropped_.load(std::memory_order_relaxed);
+            if (dropped != droppedReported_) {
+                Record notice;
+                notice.level = Utils::LOG_WARNING;
+                notice.time = std::chrono::system_clock::now();
+                notice.message = std::to_string(dropped - droppedReported_) + " log messages dropped (logger ring full)";
+                write(out, notice);
+                droppedReported_ = dropped;
+            }
+            if (batch > 0) out.flush();
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        written_.store(dequeuePos_, std::memory_order_release);
+        if (batch > 0) writtenCv_.notify_all();
+
+        if (stopping && batch == 0) break;
+        if (batch > 0) continue;
+
+        waiting_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wakeCv_.wait(lock, [this]() { return hasPending() || !running_.load(); });
+        waiting_.store(false, std::memory_order_relaxed);
+    }
+}
+
+void Logger::write(std::ostream& out, const Record& record) {
+    out << "[" << Utils::formatTimestamp(record.time) << "] [" << Utils::getLogLevelString(record.level) << "] "
+        << record.message << '\n';
+}
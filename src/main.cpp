@@ -1,9 +1,19 @@
 #include "face_enhancer.h"
 #include "image_processor.h"
+#include "pipeline_benchmark.h"
+#include "memory_tracker.h"
+#include "quality_report.h"
+#include "tracer.h"
 #include "utils.h"
 #include <iostream>
 #include <string>
 #include <chrono>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
 
 void printUsage(const std::string& programName) {
     std::cout << "\n=== Face Enhancer - C++ Image Enhancement Tool ===\n\n";
@@ -16,33 +26,70 @@ void printUsage(const std::string& programName) {
     std::cout << "  " << programName << " [OPTIONS]\n\n";
     
     std::cout << "OPTIONS:\n";
-    std::cout << "  -i, --input PATH      Input image file or directory\n";
+    std::cout << "  -i, --input PATH      Input image or video file, or directory\n";
     std::cout << "  -o, --output PATH     Output file or directory\n";
     std::cout << "  -b, --batch           Process all images in input directory\n";
+    std::cout << "  -r, --recursive       Batch through subdirectories, mirroring them under the output\n";
+    std::cout << "      --manifest FILE   Batch from a manifest: input[TAB output][TAB key=value;...]\n";
+    std::cout << "      --resume          Skip batch inputs already enhanced with the same settings\n";
+    std::cout << "      --no-probe        Don't prefilter batch inputs by their image headers\n";
+    std::cout << "      --journal FILE    Batch journal location (default: OUTPUT/.face_enhancer_journal)\n";
+    std::cout << "      --report FILE     Score existing batch outputs against their inputs into CSV or .json\n";
+    std::cout << "      --report-threads INT  Workers scoring the report (default: all cores)\n";
     std::cout << "  -c, --config FILE     Load configuration from file\n";
     std::cout << "  -v, --verbose         Enable verbose logging\n";
     std::cout << "  -p, --preview         Show before/after comparison\n";
     std::cout << "  -h, --help            Show this help message\n";
-    std::cout << "      --info            Show system information\n\n";
+    std::cout << "      --info            Show system information\n";
+    std::cout << "      --stream          Read length-prefixed images from stdin, write results to stdout\n";
+    std::cout << "      --stream-format EXT  Reply encoding in stream mode, e.g. .png (default: same as input)\n";
+    std::cout << "      --benchmark       Time the pipeline over the input image(s) decoded once, no output written\n";
+    std::cout << "      --benchmark-levels LIST  Worker counts to benchmark, e.g. 1,2,4 (default: 1)\n";
+    std::cout << "      --benchmark-iterations INT  Passes over the corpus per level (default: 3)\n";
+    std::cout << "      --benchmark-output FILE  Write benchmark results as JSON\n";
+    std::cout << "      --memory-stats    Track Mat memory per pipeline stage and log it at the end\n";
+    std::cout << "      --trace FILE      Record a timeline of stages and threads as Chrome/Perfetto trace JSON\n\n";
     
     std::cout << "ENHANCEMENT PARAMETERS:\n";
     std::cout << "  --sharpen FLOAT       Sharpening strength (default: 1.5)\n";
     std::cout << "  --denoise FLOAT       Noise reduction strength (default: 10.0)\n";
     std::cout << "  --contrast FLOAT      Contrast adjustment (default: 1.2)\n";
     std::cout << "  --brightness INT      Brightness adjustment (default: 10)\n";
-    std::cout << "  --scale INT           Super resolution scale (default: 1)\n\n";
+    std::cout << "  --scale INT           Super resolution scale (default: 1)\n";
+    std::cout << "  --max-size INT        Cap the output's longest side; JPEGs decode at reduced scale to match\n";
+    std::cout << "  --metrics-proxy INT   Compute quality metrics on a proxy with this longest side\n";
+    std::cout << "  --mmap                Decode inputs from memory-mapped files with batch readahead\n";
+    std::cout << "  --encode-preset NAME  Encoder trade-off: default, fast or small\n";
+    std::cout << "  --encoder-threads INT Threads saving batch outputs in the background (default: 2)\n";
+    std::cout << "  --landmarks FILE      LBF landmark model; keeps detail work off cheeks\n";
+    std::cout << "  --dnn-model FILE      SSD face detector weights (.pb); needs --dnn-config\n";
+    std::cout << "  --dnn-config FILE     SSD face detector graph (.pbtxt)\n";
+    std::cout << "  --dnn-batch INT       Images per DNN detection pass in batch mode (default: 8)\n";
+    std::cout << "  --adaptive            Skip stages that already-acceptable images don't need\n\n";
+    
+    std::cout << "VIDEO PARAMETERS:\n";
+    std::cout << "  --detect-every INT    Full face detection every N frames, tracking in between (default: 10)\n";
+    std::cout << "  --temporal-window INT Frames stacked for temporal denoising, 1 disables (default: 5)\n";
+    std::cout << "  --temporal-nlm        Multi-frame NLM over the stack instead of the faster mean\n\n";
     
     std::cout << "EXAMPLES:\n";
     std::cout << "  # Enhance single image\n";
     std::cout << "  " << programName << " -i blurred_face.jpg -o enhanced_face.jpg\n\n";
     std::cout << "  # Batch process directory\n";
     std::cout << "  " << programName << " -i input_dir -o output_dir --batch\n\n";
+    std::cout << "  # Quality report for a finished batch\n";
+    std::cout << "  " << programName << " -i input_dir -o output_dir --report report.csv\n\n";
+    std::cout << "  # Throughput at 1, 4 and 8 workers\n";
+    std::cout << "  " << programName << " -i corpus_dir --benchmark --benchmark-levels 1,4,8\n\n";
+    std::cout << "  # Enhance a video clip\n";
+    std::cout << "  " << programName << " -i clip.mp4 -o clip_enhanced.mp4 --detect-every 15\n\n";
     std::cout << "  # Custom enhancement settings\n";
     std::cout << "  " << programName << " -i input.jpg -o output.jpg --sharpen 2.0 --denoise 15.0\n\n";
     
     std::cout << "SUPPORTED FORMATS:\n";
     std::cout << "  Input:  JPG, JPEG, PNG, BMP, TIFF, TIF, WEBP\n";
-    std::cout << "  Output: JPG, PNG, BMP, TIFF, WEBP\n\n";
+    std::cout << "  Output: JPG, PNG, BMP, TIFF, WEBP\n";
+    std::cout << "  Video:  MP4, AVI, MOV, MKV, M4V\n\n";
 }
 
 void printVersion() {
@@ -51,7 +98,8 @@ void printVersion() {
     std::cout << "Copyright (c) 2025 Face Enhancer Project\n\n";
 }
 
-bool parseArguments(int argc, char* argv[], Utils::Config& config, FaceEnhancer::EnhancementParams& params) {
+bool parseArguments(int argc, char* argv[], Utils::Config& config, FaceEnhancer::EnhancementParams& params,
+                    FaceEnhancer::VideoParams& videoParams) {
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         
@@ -74,6 +122,61 @@ bool parseArguments(int argc, char* argv[], Utils::Config& config, FaceEnhancer:
         else if (arg == "-b" || arg == "--batch") {
             config.batchMode = true;
         }
+        else if (arg == "-r" || arg == "--recursive") {
+            config.batchMode = true;
+            params.recursiveBatch = true;
+        }
+        else if (arg == "--no-probe") {
+            params.probeBatchInputs = false;
+        }
+        else if (arg == "--resume") {
+            params.resumeBatch = true;
+        }
+        else if (arg == "--journal" && i + 1 < argc) {
+            params.resumeBatch = true;
+            params.journalPath = argv[++i];
+        }
+        else if (arg == "--benchmark") {
+            config.benchmarkMode = true;
+        }
+        else if (arg == "--benchmark-levels" && i + 1 < argc) {
+            config.benchmarkMode = true;
+            config.benchmarkLevels = argv[++i];
+        }
+        else if (arg == "--benchmark-iterations" && i + 1 < argc) {
+            config.benchmarkMode = true;
+            config.benchmarkIterations = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--benchmark-output" && i + 1 < argc) {
+            config.benchmarkMode = true;
+            config.benchmarkOutput = argv[++i];
+        }
+        else if (arg == "--memory-stats") {
+            config.memoryStats = true;
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            config.tracePath = argv[++i];
+        }
+        else if (arg == "--report" && i + 1 < argc) {
+            config.batchMode = true;
+            config.reportPath = argv[++i];
+        }
+        else if (arg == "--report-threads" && i + 1 < argc) {
+            config.reportThreads = std::max(0, std::stoi(argv[++i]));
+        }
+        else if (arg == "--manifest" && i + 1 < argc) {
+            config.batchMode = true;
+            config.manifestPath = argv[++i];
+        }
+        else if (arg == "--stream") {
+            config.streamMode = true;
+        }
+        else if (arg == "--stream-format" && i + 1 < argc) {
+            config.streamFormat = Utils::toLowerCase(argv[++i]);
+            if (!config.streamFormat.empty() && config.streamFormat[0] != '.') {
+                config.streamFormat = "." + config.streamFormat;
+            }
+        }
         else if (arg == "-p" || arg == "--preview") {
             config.showPreview = true;
         }
@@ -102,11 +205,59 @@ bool parseArguments(int argc, char* argv[], Utils::Config& config, FaceEnhancer:
         else if (arg == "--scale" && i + 1 < argc) {
             params.srScale = std::stoi(argv[++i]);
         }
+        else if (arg == "--max-size" && i + 1 < argc) {
+            params.maxOutputSide = std::max(0, std::stoi(argv[++i]));
+        }
+        else if (arg == "--encode-preset" && i + 1 < argc) {
+            std::string preset = Utils::toLowerCase(argv[++i]);
+            if (preset == "fast") {
+                params.encodePreset = ImageProcessor::ENCODE_FAST;
+            } else if (preset == "small") {
+                params.encodePreset = ImageProcessor::ENCODE_SMALL;
+            } else if (preset == "default") {
+                params.encodePreset = ImageProcessor::ENCODE_DEFAULT;
+            } else {
+                Utils::logWarning("Unknown encode preset: ", preset);
+            }
+        }
+        else if (arg == "--encoder-threads" && i + 1 < argc) {
+            params.encoderThreads = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--metrics-proxy" && i + 1 < argc) {
+            params.metricsProxySide = std::max(0, std::stoi(argv[++i]));
+        }
+        else if (arg == "--mmap") {
+            params.memoryMappedInput = true;
+        }
+        else if (arg == "--landmarks" && i + 1 < argc) {
+            params.landmarkModelPath = argv[++i];
+        }
+        else if (arg == "--dnn-model" && i + 1 < argc) {
+            params.dnnModelPath = argv[++i];
+        }
+        else if (arg == "--dnn-config" && i + 1 < argc) {
+            params.dnnConfigPath = argv[++i];
+        }
+        else if (arg == "--dnn-batch" && i + 1 < argc) {
+            params.dnnBatchSize = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--adaptive") {
+            params.adaptiveRouting = true;
+        }
+        else if (arg == "--detect-every" && i + 1 < argc) {
+            videoParams.detectionInterval = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--temporal-window" && i + 1 < argc) {
+            videoParams.temporalWindow = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--temporal-nlm") {
+            videoParams.temporalNLM = true;
+        }
         else if (arg.substr(0, 2) == "--") {
-            Utils::logWarning("Unknown option: " + arg);
+            Utils::logWarning("Unknown option: ", arg);
         }
         else {
-            Utils::logWarning("Unknown argument: " + arg);
+            Utils::logWarning("Unknown argument: ", arg);
         }
     }
     
@@ -114,29 +265,50 @@ bool parseArguments(int argc, char* argv[], Utils::Config& config, FaceEnhancer:
 }
 
 bool validateInputs(const Utils::Config& config) {
-    if (config.inputPath.empty()) {
+    if (config.streamMode) {
+        return true;  // images arrive on stdin
+    }
+    
+    if (config.inputPath.empty() && config.manifestPath.empty()) {
         Utils::logError("Input path is required. Use -i or --input to specify.");
         return false;
     }
     
+    if (config.benchmarkMode) {
+        if (!Utils::fileExists(config.inputPath) && !Utils::directoryExists(config.inputPath)) {
+            Utils::logError("Benchmark input does not exist: ", config.inputPath);
+            return false;
+        }
+        return true;  // nothing is written except the optional results file
+    }
+    
     if (config.outputPath.empty()) {
         Utils::logError("Output path is required. Use -o or --output to specify.");
         return false;
     }
     
-    if (config.batchMode) {
+    if (!config.manifestPath.empty()) {
+        if (!Utils::fileExists(config.manifestPath)) {
+            Utils::logError("Manifest file does not exist: ", config.manifestPath);
+            return false;
+        }
+    } else if (config.batchMode) {
         if (!Utils::directoryExists(config.inputPath)) {
-            Utils::logError("Input directory does not exist: " + config.inputPath);
+            Utils::logError("Input directory does not exist: ", config.inputPath);
+            return false;
+        }
+        if (!config.reportPath.empty() && !Utils::directoryExists(config.outputPath)) {
+            Utils::logError("Output directory to report on does not exist: ", config.outputPath);
             return false;
         }
     } else {
         if (!Utils::fileExists(config.inputPath)) {
-            Utils::logError("Input file does not exist: " + config.inputPath);
+            Utils::logError("Input file does not exist: ", config.inputPath);
             return false;
         }
         
-        if (!ImageProcessor::isValidImageFile(config.inputPath)) {
-            Utils::logError("Input file is not a valid image format: " + config.inputPath);
+        if (!ImageProcessor::isValidImageFile(config.inputPath) && !ImageProcessor::isValidVideoFile(config.inputPath)) {
+            Utils::logError("Input file is not a valid image or video format: ", config.inputPath);
             return false;
         }
     }
@@ -146,23 +318,93 @@ bool validateInputs(const Utils::Config& config) {
 
 void printEnhancementSummary(const Utils::Config& config, const FaceEnhancer::EnhancementParams& params) {
     Utils::logInfo("=== Enhancement Summary ===");
-    Utils::logInfo("Mode: " + std::string(config.batchMode ? "Batch processing" : "Single image"));
-    Utils::logInfo("Input: " + config.inputPath);
-    Utils::logInfo("Output: " + config.outputPath);
-    Utils::logInfo("Sharpen strength: " + std::to_string(params.sharpenStrength));
-    Utils::logInfo("Noise reduction: " + std::to_string(params.noiseReductionStrength));
-    Utils::logInfo("Contrast: " + std::to_string(params.alpha));
-    Utils::logInfo("Brightness: " + std::to_string(params.beta));
+    Utils::logInfo("Mode: ", config.streamMode ? "Stream" : config.benchmarkMode ? "Benchmark" :
+                   !config.reportPath.empty() ? "Quality report" :
+                   config.batchMode ? "Batch processing" :
+                   ImageProcessor::isValidVideoFile(config.inputPath) ? "Video" : "Single image");
+    Utils::logInfo("Input: ", (config.manifestPath.empty() ? config.inputPath : config.manifestPath));
+    Utils::logInfo("Output: ", config.outputPath);
+    Utils::logInfo("Sharpen strength: ", params.sharpenStrength);
+    Utils::logInfo("Noise reduction: ", params.noiseReductionStrength);
+    Utils::logInfo("Contrast: ", params.alpha);
+    Utils::logInfo("Brightness: ", params.beta);
     if (params.srScale > 1) {
-        Utils::logInfo("Super resolution scale: " + std::to_string(params.srScale));
+        Utils::logInfo("Super resolution scale: ", params.srScale);
+    }
+    if (params.maxOutputSide > 0) {
+        Utils::logInfo("Max output size: ", params.maxOutputSide, " px");
     }
     Utils::logInfo("==========================");
 }
 
+bool runQualityReport(const Utils::Config& config, const FaceEnhancer::EnhancementParams& params) {
+    // Inputs pair with outputs exactly as a batch run with the same options named them
+    BatchSource::Mode mode = !config.manifestPath.empty() ? BatchSource::MANIFEST
+                           : params.recursiveBatch ? BatchSource::RECURSIVE_DIRECTORY : BatchSource::FLAT_DIRECTORY;
+    BatchSource::Options options;
+    options.probeHeaders = params.probeBatchInputs;
+    // Report workers score several pairs at once, so large images are worth starting first
+    if (params.probeBatchInputs && config.reportThreads != 1) {
+        options.sortWindow = 64;
+    }
+    BatchSource source(mode, config.manifestPath.empty() ? config.inputPath : config.manifestPath, config.outputPath,
+                       [](const std::string& file) { return ImageProcessor::isValidImageFile(file); }, options);
+    
+    QualityReport report(config.reportThreads, params.metricsProxySide);
+    Utils::logInfo("Scoring batch outputs...");
+    bool scored = report.run(source);
+    bool written = report.write(config.reportPath);
+    report.logSummary();
+    
+    if (!scored) {
+        Utils::logError("No input/output pairs could be scored");
+    }
+    return scored && written;
+}
+
+bool runBenchmark(const Utils::Config& config, const FaceEnhancer::EnhancementParams& params) {
+    std::vector<int> levels;
+    for (const auto& level : Utils::split(config.benchmarkLevels, ',')) {
+        if (!Utils::trim(level).empty()) levels.push_back(std::stoi(level));
+    }
+    
+    PipelineBenchmark benchmark(params, config.benchmarkIterations);
+    if (benchmark.loadCorpus(config.inputPath) == 0) {
+        Utils::logError("No benchmark images could be decoded from ", config.inputPath);
+        return false;
+    }
+    
+    // Installed after the corpus is decoded, so Mat peaks count only what the workers allocate
+    MemoryTracker::install();
+    
+    // Per-image pipeline logging would dominate the timings, so only warnings get through unless verbose
+    if (!config.verbose) {
+        Utils::setLogLevel(Utils::LOG_WARNING);
+    }
+    bool ran = benchmark.run(levels);
+    Utils::setLogLevel(config.verbose ? Utils::LOG_DEBUG : Utils::LOG_INFO);
+    
+    benchmark.logSummary();
+    if (ran && !config.benchmarkOutput.empty()) {
+        return benchmark.write(config.benchmarkOutput);
+    }
+    return ran;
+}
+
 int main(int argc, char* argv[]) {
     try {
+        // In stream mode stdout carries image data, so logs move to stderr before anything is printed
+        bool streamMode = std::any_of(argv + 1, argv + argc, [](const char* arg) { return std::string(arg) == "--stream"; });
+        if (streamMode) {
+            Utils::setLogStream(std::cerr);
+#ifdef _WIN32
+            _setmode(_fileno(stdin), _O_BINARY);
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        }
+        
         // Print application header
-        std::cout << "\n";
+        (streamMode ? std::cerr : std::cout) << "\n";
         Utils::logInfo("Face Enhancer - Advanced Image Enhancement Tool");
         Utils::logInfo("Initializing...");
         
@@ -178,12 +420,24 @@ int main(int argc, char* argv[]) {
         config.sharpenStrength = 1.5;
         config.noiseReduction = 10.0;
         config.superResolutionScale = 1;
+        config.streamMode = false;
+        config.streamFormat = "";
+        config.manifestPath = "";
+        config.reportPath = "";
+        config.reportThreads = 0;
+        config.benchmarkMode = false;
+        config.benchmarkLevels = "1";
+        config.benchmarkIterations = 3;
+        config.benchmarkOutput = "";
+        config.memoryStats = false;
+        config.tracePath = "";
         
         // Initialize enhancement parameters with defaults
         FaceEnhancer::EnhancementParams params;
+        FaceEnhancer::VideoParams videoParams;
         
         // Parse command line arguments
-        if (!parseArguments(argc, argv, config, params)) {
+        if (!parseArguments(argc, argv, config, params, videoParams)) {
             return 0; // Help was shown or error occurred
         }
         
@@ -192,6 +446,16 @@ int main(int argc, char* argv[]) {
             Utils::setLogLevel(Utils::LOG_DEBUG);
         }
         
+        // From here on all output goes through the logger, so workers hand records to its writer thread
+        Utils::setAsyncLogging(true);
+        
+        if (config.memoryStats) {
+            MemoryTracker::install();
+        }
+        if (!config.tracePath.empty()) {
+            Tracer::enable(config.tracePath);
+        }
+        
         // Validate inputs
         if (!validateInputs(config)) {
             Utils::logError("Input validation failed. Use --help for usage information.");
@@ -201,17 +465,38 @@ int main(int argc, char* argv[]) {
         // Print enhancement summary
         printEnhancementSummary(config, params);
         
+        if (config.benchmarkMode) {
+            return runBenchmark(config, params) ? 0 : 1;
+        }
+        
+        if (!config.reportPath.empty()) {
+            // Scoring only reads existing outputs, so no enhancer (or model) is needed
+            return runQualityReport(config, params) ? 0 : 1;
+        }
+        
         // Initialize face enhancer
         Utils::logInfo("Initializing Face Enhancer...");
         FaceEnhancer enhancer;
         enhancer.setEnhancementParams(params);
+        enhancer.setVideoParams(videoParams);
         
         bool success = false;
+        FaceEnhancer::QualityMetrics metrics;
+        bool videoMode = !config.batchMode && !config.streamMode && ImageProcessor::isValidVideoFile(config.inputPath);
         
-        if (config.batchMode) {
+        if (config.streamMode) {
+            // One warm enhancer serves every image on the stream
+            Utils::logInfo("Streaming images from stdin...");
+            success = enhancer.enhanceStream(std::cin, std::cout, config.streamFormat);
+        } else if (config.batchMode) {
             // Batch processing
             Utils::logInfo("Starting batch processing...");
-            success = enhancer.enhanceBatch(config.inputPath, config.outputPath);
+            success = config.manifestPath.empty() ? enhancer.enhanceBatch(config.inputPath, config.outputPath)
+                                                  : enhancer.enhanceManifest(config.manifestPath, config.outputPath);
+        } else if (videoMode) {
+            // Video processing
+            Utils::logInfo("Processing video...");
+            success = enhancer.enhanceVideo(config.inputPath, config.outputPath);
         } else {
             // Single image processing
             Utils::logInfo("Processing single image...");
@@ -223,11 +508,13 @@ int main(int argc, char* argv[]) {
                     cv::Mat enhancedImage;
                     if (enhancer.enhanceImage(originalImage, enhancedImage)) {
                         ImageProcessor::showImageComparison(originalImage, enhancedImage, "Face Enhancement Result");
-                        success = ImageProcessor::saveImage(enhancedImage, config.outputPath);
+                        success = ImageProcessor::saveImage(enhancedImage, config.outputPath,
+                                                            params.outputQuality, params.encodePreset);
+                        metrics = FaceEnhancer::computeQualityMetrics(originalImage, enhancedImage, params.metricsProxySide);
                     }
                 }
             } else {
-                success = enhancer.enhanceImage(config.inputPath, config.outputPath);
+                success = enhancer.enhanceImage(config.inputPath, config.outputPath, &metrics);
             }
         }
         
@@ -236,26 +523,19 @@ int main(int argc, char* argv[]) {
         
         if (success) {
             Utils::logInfo("Enhancement completed successfully!");
-            Utils::logInfo("Total processing time: " + std::to_string(totalTime) + " ms");
+            Utils::logInfo("Total processing time: ", totalTime, " ms");
+            MemoryTracker::logSummary();
             
-            if (!config.batchMode) {
-                // Display image quality metrics for single image
-                cv::Mat original = ImageProcessor::loadImage(config.inputPath);
-                cv::Mat enhanced = ImageProcessor::loadImage(config.outputPath);
-                
-                if (!original.empty() && !enhanced.empty()) {
-                    double psnr = ImageProcessor::calculatePSNR(original, enhanced);
-                    double ssim = ImageProcessor::calculateSSIM(original, enhanced);
-                    double sharpnessOrig = ImageProcessor::calculateSharpness(original);
-                    double sharpnessEnh = ImageProcessor::calculateSharpness(enhanced);
-                    
-                    Utils::logInfo("=== Quality Metrics ===");
-                    Utils::logInfo("PSNR: " + std::to_string(psnr) + " dB");
-                    Utils::logInfo("SSIM: " + std::to_string(ssim));
-                    Utils::logInfo("Sharpness improvement: " + 
-                                  std::to_string(sharpnessEnh / sharpnessOrig) + "x");
-                    Utils::logInfo("=====================");
-                }
+            if (metrics.computed) {
+                // Display image quality metrics for single image, computed in memory alongside the save
+                Utils::logInfo("=== Quality Metrics ===");
+                Utils::logInfo("Evaluated at: ", metrics.evaluatedSize.width, "x", metrics.evaluatedSize.height);
+                Utils::logInfo("PSNR: ", metrics.psnr, " dB");
+                Utils::logInfo("SSIM: ", metrics.ssim);
+                Utils::logInfo("MS-SSIM: ", metrics.msssim);
+                Utils::logInfo("Sharpness improvement: ",
+                               metrics.sharpnessEnhanced / std::max(metrics.sharpnessOriginal, 1e-9), "x");
+                Utils::logInfo("=====================");
             }
             
             return 0;
@@ -265,10 +545,10 @@ int main(int argc, char* argv[]) {
         }
         
     } catch (const Utils::FaceEnhancerException& e) {
-        Utils::logError("Face Enhancer Error: " + std::string(e.what()));
+        Utils::logError("Face Enhancer Error: ", e.what());
         return 1;
     } catch (const std::exception& e) {
-        Utils::logError("Unexpected error: " + std::string(e.what()));
+        Utils::logError("Unexpected error: ", e.what());
         return 1;
     } catch (...) {
         Utils::logError("Unknown error occurred");
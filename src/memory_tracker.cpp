@@ -0,0 +1,268 @@
+#include "memory_tracker.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+namespace {
+
+const int kMaxStages = 64;  // later stages share slot 0 with untracked allocations; a power of two
+
+struct StageCounters {
+    std::atomic<size_t> live{0};
+    std::atomic<size_t> peak{0};
+    std::atomic<size_t> peakTotal{0};
+    std::atomic<size_t> allocated{0};
+    std::atomic<size_t> allocations{0};
+};
+
+std::atomic<bool> installed(false);
+std::atomic<size_t> liveBytes(0);
+std::atomic<size_t> peakBytes(0);
+
+// Constant-initialized so Stage objects in other translation units can register during static init
+StageCounters stages[kMaxStages];
+const char* stageNames[kMaxStages] = {"Other"};
+std::atomic<int> stageCount(1);
+std::mutex stageMutex;  // registration only; counters are lock-free
+
+template <typename T>
+void updateMax(std::atomic<T>& target, T value) {
+    T current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+// One per beginImage; the thread that began it and every live buffer charged to it hold a reference
+struct alignas(kMaxStages) MemoryTracker::ImageOwner {
+    std::atomic<long long> live{0};
+    std::atomic<long long> peak{0};
+    std::atomic<int> references{1};
+};
+
+namespace {
+
+using ImageOwner = MemoryTracker::ImageOwner;
+
+void release(ImageOwner* owner) {
+    if (owner && owner->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete owner;
+    }
+}
+
+// Drops the thread's reference to its last image when the thread exits
+struct ThreadImage {
+    ImageOwner* owner = nullptr;
+    ~ThreadImage() { release(owner); }
+};
+
+thread_local int currentStage = 0;
+thread_local ImageOwner* currentImage = nullptr;  // this thread's own image or one adopted by ContextScope
+thread_local ThreadImage ownImage;
+
+// The owner's alignment leaves the low bits free for the stage index
+static_assert(alignof(ImageOwner) >= kMaxStages, "stage index must fit below the owner pointer");
+
+void* packOwner(ImageOwner* owner, int stage) {
+    return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(owner) | static_cast<uintptr_t>(stage));
+}
+
+ImageOwner* ownerOf(const void* userdata) {
+    return reinterpret_cast<ImageOwner*>(reinterpret_cast<uintptr_t>(userdata) & ~static_cast<uintptr_t>(kMaxStages - 1));
+}
+
+int stageOf(const void* userdata) {
+    return static_cast<int>(reinterpret_cast<uintptr_t>(userdata) & (kMaxStages - 1));
+}
+
+} // namespace
+
+// Wraps the standard allocator; each buffer's image and stage ride in UMatData::userdata
+class MemoryTracker::CountingAllocator : public cv::MatAllocator {
+public:
+    explicit CountingAllocator(cv::MatAllocator* base) : base_(base) {}
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        cv::UMatData* u = base_->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        if (!u) return u;
+        u->prevAllocator = u->currAllocator = this;
+        if (u->flags & cv::UMatData::USER_ALLOCATED) return u;
+
+        int stage = currentStage;
+        ImageOwner* image = currentImage;
+        u->userdata = packOwner(image, stage);
+
+        size_t total = liveBytes.fetch_add(u->size, std::memory_order_relaxed) + u->size;
+        updateMax(peakBytes, total);
+
+        StageCounters& counters = stages[stage];
+        size_t live = counters.live.fetch_add(u->size, std::memory_order_relaxed) + u->size;
+        updateMax(counters.peak, live);
+        updateMax(counters.peakTotal, total);
+        counters.allocated.fetch_add(u->size, std::memory_order_relaxed);
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+
+        if (image) {
+            image->references.fetch_add(1, std::memory_order_relaxed);
+            long long imageLive = image->live.fetch_add(static_cast<long long>(u->size), std::memory_order_relaxed) +
+                                  static_cast<long long>(u->size);
+            updateMax(image->peak, imageLive);
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override {
+        return base_->allocate(u, accessFlags, usageFlags);
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (!u) return;
+        if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+            ImageOwner* image = ownerOf(u->userdata);
+            liveBytes.fetch_sub(u->size, std::memory_order_relaxed);
+            stages[stageOf(u->userdata)].live.fetch_sub(u->size, std::memory_order_relaxed);
+            if (image) {
+                image->live.fetch_sub(static_cast<long long>(u->size), std::memory_order_relaxed);
+                release(image);
+            }
+            u->userdata = nullptr;
+        }
+        u->currAllocator = base_;
+        base_->deallocate(u);
+    }
+
+private:
+    cv::MatAllocator* base_;
+};
+
+void MemoryTracker::install() {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        // Leaked on purpose: Mats destroyed during static teardown still free through it
+        static CountingAllocator* allocator = new CountingAllocator(cv::Mat::getStdAllocator());
+        cv::Mat::setDefaultAllocator(allocator);
+        installed.store(true, std::memory_order_release);
+        Utils::logDebug("Mat allocation tracking enabled");
+    });
+}
+
+bool MemoryTracker::isInstalled() {
+    return installed.load(std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::getLiveBytes() {
+    return liveBytes.load(std::memory_order_relaxed);
+}
+
+size_t MemoryTracker::getPeakBytes() {
+    return peakBytes.load(std::memory_order_relaxed);
+}
+
+std::vector<MemoryTracker::StageStats> MemoryTracker::getStageStats() {
+    std::vector<StageStats> result;
+    std::lock_guard<std::mutex> lock(stageMutex);
+    int count = stageCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        StageStats stats;
+        stats.name = stageNames[i];
+        stats.liveBytes = stages[i].live.load(std::memory_order_relaxed);
+        stats.peakBytes = stages[i].peak.load(std::memory_order_relaxed);
+        stats.peakTotalBytes = stages[i].peakTotal.load(std::memory_order_relaxed);
+        stats.allocatedBytes = stages[i].allocated.load(std::memory_order_relaxed);
+        stats.allocations = stages[i].allocations.load(std::memory_order_relaxed);
+        if (stats.allocations > 0) result.push_back(stats);
+    }
+    return result;
+}
+
+void MemoryTracker::resetPeaks() {
+    peakBytes.store(liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    int count = stageCount.load(std::memory_order_acquire);
+    for (int i = 0; i < count; ++i) {
+        stages[i].peak.store(stages[i].live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        stages[i].peakTotal.store(0, std::memory_order_relaxed);
+    }
+}
+
+void MemoryTracker::logSummary() {
+    if (!isInstalled()) return;
+
+    Utils::logInfo("=== Memory ===");
+    Utils::logInfo("Current RSS: ", Utils::formatFileSize(Utils::getMemoryUsage()),
+                   ", peak RSS: ", Utils::formatFileSize(Utils::getPeakMemoryUsage()));
+    Utils::logInfo("Mat bytes live: ", Utils::formatFileSize(getLiveBytes()),
+                   ", peak: ", Utils::formatFileSize(getPeakBytes()));
+
+    std::vector<StageStats> stats = getStageStats();
+    std::sort(stats.begin(), stats.end(), [](const StageStats& a, const StageStats& b) {
+        return a.peakTotalBytes > b.peakTotalBytes;
+    });
+    for (const auto& stage : stats) {
+        Utils::logInfo("  ", stage.name, ": peak ", Utils::formatFileSize(stage.peakBytes),
+                       " own, ", Utils::formatFileSize(stage.peakTotalBytes), " total, ",
+                       stage.allocations, " allocations");
+    }
+    Utils::logInfo("==============");
+}
+
+MemoryTracker::Stage::Stage(const char* name)
+    : index_(0) {
+    std::lock_guard<std::mutex> lock(stageMutex);
+    int count = stageCount.load(std::memory_order_relaxed);
+    for (int i = 0; i < count; ++i) {
+        if (std::strcmp(stageNames[i], name) == 0) {
+            index_ = i;
+            return;
+        }
+    }
+    if (count == kMaxStages) return;
+
+    stageNames[count] = name;
+    stageCount.store(count + 1, std::memory_order_release);
+    index_ = count;
+}
+
+MemoryTracker::StageScope::StageScope(const Stage& stage)
+    : previous_(currentStage) {
+    if (isInstalled()) {
+        currentStage = stage.index();
+    }
+}
+
+MemoryTracker::StageScope::~StageScope() {
+    currentStage = previous_;
+}
+
+void MemoryTracker::beginImage() {
+    if (!isInstalled()) return;
+    release(ownImage.owner);
+    ownImage.owner = new ImageOwner();
+    currentImage = ownImage.owner;
+}
+
+size_t MemoryTracker::getImagePeakBytes() {
+    return currentImage ? static_cast<size_t>(currentImage->peak.load(std::memory_order_relaxed)) : 0;
+}
+
+MemoryTracker::Context MemoryTracker::currentContext() {
+    Context context;
+    context.image = currentImage;
+    context.stage = currentStage;
+    return context;
+}
+
+MemoryTracker::ContextScope::ContextScope(const Context& context)
+    : previous_(currentContext()) {
+    currentImage = context.image;
+    currentStage = context.stage;
+}
+
+MemoryTracker::ContextScope::~ContextScope() {
+    currentImage = previous_.image;
+    currentStage = previous_.stage;
+}
@@ -0,0 +1,204 @@
+#include "pipeline_benchmark.h"
+#include "image_processor.h"
+#include "memory_tracker.h"
+#include "tracer.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+PipelineBenchmark::PipelineBenchmark(const FaceEnhancer::EnhancementParams& params, int iterations)
+    : params_(params)
+    , iterations_(std::max(1, iterations))
+    , corpusMegapixels_(0.0) {
+}
+
+size_t PipelineBenchmark::loadCorpus(const std::string& path) {
+    std::vector<std::string> files;
+    if (Utils::directoryExists(path)) {
+        files = ImageProcessor::getImagesInDirectory(path);
+    } else {
+        files.push_back(path);
+    }
+
+    for (const auto& file : files) {
+        cv::Mat image = ImageProcessor::loadImage(file);
+        if (image.empty()) {
+            Utils::logWarning("Skipping unreadable benchmark input: ", file);
+            continue;
+        }
+        corpusMegapixels_ += image.total() / 1e6;
+        corpus_.push_back(image);
+    }
+
+    Utils::logInfo("Benchmark corpus: ", corpus_.size(), " images, ", corpusMegapixels_, " MP");
+    return corpus_.size();
+}
+
+bool PipelineBenchmark::run(const std::vector<int>& concurrencyLevels) {
+    if (corpus_.empty()) {
+        Utils::logError("Benchmark corpus is empty");
+        return false;
+    }
+
+    results_.clear();
+    for (int concurrency : concurrencyLevels) {
+        if (concurrency < 1) continue;
+        Utils::logInfo("Benchmarking with ", concurrency, " worker(s)...");
+        results_.push_back(runLevel(concurrency));
+    }
+    return !results_.empty();
+}
+
+PipelineBenchmark::LevelResult PipelineBenchmark::runLevel(int concurrency) {
+    LevelResult result;
+    result.concurrency = concurrency;
+
+    // FaceEnhancer keeps per-run state, so each worker owns one; models load before timing starts
+    std::vector<std::unique_ptr<FaceEnhancer>> enhancers;
+    for (int i = 0; i < concurrency; ++i) {
+        enhancers.push_back(std::make_unique<FaceEnhancer>());
+        enhancers.back()->setEnhancementParams(params_);
+
+        cv::Mat warmup;
+        enhancers.back()->enhanceImage(corpus_.front(), warmup);
+    }
+
+    const size_t total = corpus_.size() * static_cast<size_t>(iterations_);
+    std::atomic<size_t> nextImage(0);
+    std::atomic<size_t> failures(0);
+    std::mutex resultsMutex;
+    std::vector<double> latencies;
+    std::vector<double> imagePeaks;
+    std::map<std::string, std::pair<double, size_t>> stageTotals;
+
+    MemoryTracker::resetPeaks();
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < concurrency; ++i) {
+        workers.emplace_back([&, i]() {
+            Tracer::setThreadName("benchmark worker " + std::to_string(i + 1));
+            FaceEnhancer& enhancer = *enhancers[i];
+            std::vector<double> localLatencies;
+            std::vector<double> localPeaks;
+            std::map<std::string, std::pair<double, size_t>> localStages;
+
+            for (size_t index = nextImage++; index < total; index = nextImage++) {
+                cv::Mat output;
+                Tracer::ImageScope traceImage(Tracer::isEnabled() ? "image " + std::to_string(index % corpus_.size()) : std::string());
+                auto imageStart = std::chrono::high_resolution_clock::now();
+                bool ok = enhancer.enhanceImage(corpus_[index % corpus_.size()], output);
+                localLatencies.push_back(Utils::getElapsedTime(imageStart));
+                localPeaks.push_back(static_cast<double>(enhancer.getLastPeakMatBytes()));
+                if (!ok) ++failures;
+
+                for (const auto& stage : enhancer.getLastStageTimes()) {
+                    auto& entry = localStages[stage.first];
+                    entry.first += stage.second;
+                    entry.second++;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            latencies.insert(latencies.end(), localLatencies.begin(), localLatencies.end());
+            imagePeaks.insert(imagePeaks.end(), localPeaks.begin(), localPeaks.end());
+            for (const auto& stage : localStages) {
+                stageTotals[stage.first].first += stage.second.first;
+                stageTotals[stage.first].second += stage.second.second;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    result.wallMs = Utils::getElapsedTime(startTime);
+    result.images = latencies.size();
+    result.failures = failures.load();
+    result.imagesPerSecond = result.wallMs > 0.0 ? result.images * 1000.0 / result.wallMs : 0.0;
+    result.latencyMs = Utils::SampleStats::of(latencies);
+    for (const auto& stage : stageTotals) {
+        result.stageMeanMs[stage.first] = stage.second.first / std::max<size_t>(1, stage.second.second);
+    }
+    result.peakRssBytes = Utils::getPeakMemoryUsage();
+    if (MemoryTracker::isInstalled()) {
+        result.peakMatBytes = MemoryTracker::getPeakBytes();
+        result.imagePeakMatBytes = Utils::SampleStats::of(imagePeaks);
+        for (const auto& stage : MemoryTracker::getStageStats()) {
+            if (stage.peakTotalBytes > 0) result.stagePeakMatBytes[stage.name] = stage.peakTotalBytes;
+        }
+    }
+    return result;
+}
+
+bool PipelineBenchmark::write(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        Utils::logError("Could not write benchmark results: ", path);
+        return false;
+    }
+
+    file << std::setprecision(8);
+    file << "{\n";
+    file << "  \"opencv\": \"" << CV_VERSION << "\",\n";
+    file << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    file << "  \"timestamp\": \"" << Utils::getCurrentTimestamp() << "\",\n";
+    file << "  \"corpus_images\": " << corpus_.size() << ",\n";
+    file << "  \"corpus_megapixels\": " << corpusMegapixels_ << ",\n";
+    file << "  \"iterations\": " << iterations_ << ",\n";
+    file << "  \"levels\": [\n";
+    for (size_t i = 0; i < results_.size(); ++i) {
+        const auto& r = results_[i];
+        file << "    {\"concurrency\": " << r.concurrency << ", \"images\": " << r.images
+             << ", \"failures\": " << r.failures << ", \"wall_ms\": " << r.wallMs
+             << ", \"images_per_second\": " << r.imagesPerSecond
+             << ", \"latency_ms\": {\"mean\": " << r.latencyMs.mean << ", \"p50\": " << r.latencyMs.p50
+             << ", \"p95\": " << r.latencyMs.p95 << ", \"p99\": " << r.latencyMs.p99
+             << ", \"max\": " << r.latencyMs.max << "}"
+             << ", \"peak_rss_bytes\": " << r.peakRssBytes
+             << ", \"peak_mat_bytes\": " << r.peakMatBytes
+             << ", \"image_peak_mat_bytes\": {\"mean\": " << r.imagePeakMatBytes.mean
+             << ", \"p50\": " << r.imagePeakMatBytes.p50 << ", \"p95\": " << r.imagePeakMatBytes.p95
+             << ", \"max\": " << r.imagePeakMatBytes.max << "}"
+             << ", \"stage_mean_ms\": {";
+        size_t stageIndex = 0;
+        for (const auto& stage : r.stageMeanMs) {
+            file << (stageIndex++ ? ", " : "") << "\"" << stage.first << "\": " << stage.second;
+        }
+        file << "}, \"stage_peak_mat_bytes\": {";
+        stageIndex = 0;
+        for (const auto& stage : r.stagePeakMatBytes) {
+            file << (stageIndex++ ? ", " : "") << "\"" << stage.first << "\": " << stage.second;
+        }
+        file << "}}" << (i + 1 < results_.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n";
+    file << "}\n";
+
+    Utils::logInfo("Benchmark results written to ", path);
+    return file.good();
+}
+
+void PipelineBenchmark::logSummary() const {
+    Utils::logInfo("=== Pipeline Benchmark ===");
+    Utils::logInfo("Corpus: ", corpus_.size(), " images x ", iterations_, " iterations");
+    for (const auto& r : results_) {
+        Utils::logInfo("Workers ", r.concurrency, ": ", r.imagesPerSecond, " images/sec, latency p50 ",
+                       r.latencyMs.p50, " ms, p95 ", r.latencyMs.p95, " ms, p99 ", r.latencyMs.p99, " ms, peak RSS ",
+                       Utils::formatFileSize(r.peakRssBytes),
+                       (r.failures ? ", " + std::to_string(r.failures) + " failed" : ""));
+        for (const auto& stage : r.stageMeanMs) {
+            Utils::logInfo("  ", stage.first, ": ", stage.second, " ms");
+        }
+        if (r.peakMatBytes > 0) {
+            Utils::logInfo("  Mat memory: peak ", Utils::formatFileSize(r.peakMatBytes), ", per image p95 ",
+                           Utils::formatFileSize(static_cast<size_t>(r.imagePeakMatBytes.p95)), ", max ",
+                           Utils::formatFileSize(static_cast<size_t>(r.imagePeakMatBytes.max)));
+        }
+    }
+    Utils::logInfo("==========================");
+}
@@ -0,0 +1,285 @@
+#include "quality_report.h"
+#include "image_processor.h"
+#include "ssim_engine.h"
+#include "tracer.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+
+namespace {
+    std::string csvField(const std::string& value) {
+        if (value.find_first_of(",\"\n") == std::string::npos) return value;
+        std::string quoted = "\"";
+        for (char c : value) {
+            if (c == '"') quoted += '"';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    double sharpnessGain(const QualityReport::Entry& entry) {
+        return entry.sharpnessEnhanced / std::max(entry.sharpnessOriginal, 1e-9);
+    }
+}
+
+QualityReport::QualityReport(int threads, int proxySide)
+    : threads_(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency()))
+    , proxySide_(std::max(0, proxySide))
+    , wallMs_(0.0) {
+}
+
+bool QualityReport::run(BatchSource& source) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    entries_.clear();
+
+    std::mutex entriesMutex;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads_; ++i) {
+        workers.emplace_back([this, &source, &entriesMutex, i]() {
+            Tracer::setThreadName("report worker " + std::to_string(i + 1));
+            BatchSource::Item item;
+            while (source.next(item)) {
+                Tracer::ImageScope traceImage(item.name);
+                Entry entry;
+                {
+                    Tracer::Span traceSpan("Score", "report");
+                    entry = evaluate(item, proxySide_);
+                }
+
+                std::lock_guard<std::mutex> lock(entriesMutex);
+                entries_.push_back(std::move(entry));
+                if (entries_.size() % 100 == 0) {
+                    Utils::logInfo("Scored ", entries_.size(), " image pairs");
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // Workers finish out of order; sort so reports diff cleanly between runs
+    std::sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) { return a.name < b.name; });
+    wallMs_ = Utils::getElapsedTime(startTime);
+
+    return std::any_of(entries_.begin(), entries_.end(), [](const Entry& entry) { return entry.ok; });
+}
+
+QualityReport::Entry QualityReport::evaluate(const BatchSource::Item& item, int proxySide) {
+    Entry entry;
+    entry.name = item.name;
+    entry.inputPath = item.inputPath;
+    entry.outputPath = item.outputPath;
+
+    try {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        if (!Utils::fileExists(item.outputPath)) {
+            entry.error = "missing output";
+            return entry;
+        }
+
+        // The original only needs decoding at the enhanced image's resolution
+        auto stageStart = std::chrono::high_resolution_clock::now();
+        cv::Mat enhanced = ImageProcessor::loadImage(item.outputPath);
+        if (enhanced.empty()) {
+            entry.error = "unreadable output";
+            return entry;
+        }
+        cv::Mat original = ImageProcessor::loadImage(item.inputPath, std::max(enhanced.cols, enhanced.rows));
+        if (original.empty()) {
+            entry.error = "unreadable input";
+            return entry;
+        }
+        entry.decodeMs = Utils::getElapsedTime(stageStart);
+        entry.inputSize = original.size();
+        entry.outputSize = enhanced.size();
+
+        stageStart = std::chrono::high_resolution_clock::now();
+        cv::Mat reference, result;
+        ImageProcessor::alignForComparison(original, enhanced, reference, result, proxySide);
+        entry.resampleMs = Utils::getElapsedTime(stageStart);
+
+        stageStart = std::chrono::high_resolution_clock::now();
+        entry.psnr = ImageProcessor::calculatePSNR(reference, result);
+        entry.psnrMs = Utils::getElapsedTime(stageStart);
+
+        // Parallelism comes from the report's workers, so each image is scored as one band
+        SSIMEngine::Options ssimOptions;
+        ssimOptions.bandRows = std::max(1, result.rows);
+        stageStart = std::chrono::high_resolution_clock::now();
+        entry.ssim = SSIMEngine::ssim(reference, result, ssimOptions);
+        entry.msssim = SSIMEngine::msssim(reference, result, ssimOptions);
+        entry.ssimMs = Utils::getElapsedTime(stageStart);
+
+        stageStart = std::chrono::high_resolution_clock::now();
+        entry.sharpnessOriginal = ImageProcessor::calculateSharpness(reference);
+        entry.sharpnessEnhanced = ImageProcessor::calculateSharpness(result);
+        entry.sharpnessMs = Utils::getElapsedTime(stageStart);
+
+        entry.totalMs = Utils::getElapsedTime(startTime);
+        entry.ok = true;
+
+    } catch (const std::exception& e) {
+        entry.error = e.what();
+        Utils::logError("Exception scoring ", item.name, ": ", e.what());
+    }
+
+    return entry;
+}
+
+std::vector<std::pair<std::string, Utils::SampleStats>> QualityReport::summarize() const {
+    const std::vector<std::pair<std::string, double (*)(const Entry&)>> columns = {
+        {"psnr", [](const Entry& e) { return e.psnr; }},
+        {"ssim", [](const Entry& e) { return e.ssim; }},
+        {"msssim", [](const Entry& e) { return e.msssim; }},
+        {"sharpness_gain", [](const Entry& e) { return sharpnessGain(e); }},
+        {"decode_ms", [](const Entry& e) { return e.decodeMs; }},
+        {"resample_ms", [](const Entry& e) { return e.resampleMs; }},
+        {"psnr_ms", [](const Entry& e) { return e.psnrMs; }},
+        {"ssim_ms", [](const Entry& e) { return e.ssimMs; }},
+        {"sharpness_ms", [](const Entry& e) { return e.sharpnessMs; }},
+        {"total_ms", [](const Entry& e) { return e.totalMs; }},
+    };
+
+    std::vector<std::pair<std::string, Utils::SampleStats>> summary;
+    for (const auto& column : columns) {
+        std::vector<double> values;
+        for (const auto& entry : entries_) {
+            if (entry.ok) values.push_back(column.second(entry));
+        }
+        summary.emplace_back(column.first, Utils::SampleStats::of(std::move(values)));
+    }
+    return summary;
+}
+
+bool QualityReport::write(const std::string& reportPath) const {
+    try {
+        if (Utils::toLowerCase(Utils::getFileExtension(reportPath)) == ".json") {
+            return writeJson(reportPath);
+        }
+        return writeCsv(reportPath);
+    } catch (const std::exception& e) {
+        Utils::logError("Exception writing quality report: ", e.what());
+        return false;
+    }
+}
+
+bool QualityReport::writeCsv(const std::string& reportPath) const {
+    std::ofstream file(reportPath);
+    if (!file.is_open()) {
+        Utils::logError("Could not write quality report: ", reportPath);
+        return false;
+    }
+
+    file << std::setprecision(10);
+    file << "name,input,output,status,input_width,input_height,output_width,output_height,"
+            "psnr,ssim,msssim,sharpness_original,sharpness_enhanced,"
+            "decode_ms,resample_ms,psnr_ms,ssim_ms,sharpness_ms,total_ms,error\n";
+    for (const auto& e : entries_) {
+        file << csvField(e.name) << ',' << csvField(e.inputPath) << ',' << csvField(e.outputPath) << ','
+             << (e.ok ? "ok" : "failed") << ','
+             << e.inputSize.width << ',' << e.inputSize.height << ','
+             << e.outputSize.width << ',' << e.outputSize.height << ','
+             << e.psnr << ',' << e.ssim << ',' << e.msssim << ','
+             << e.sharpnessOriginal << ',' << e.sharpnessEnhanced << ','
+             << e.decodeMs << ',' << e.resampleMs << ',' << e.psnrMs << ','
+             << e.ssimMs << ',' << e.sharpnessMs << ',' << e.totalMs << ','
+             << csvField(e.error) << '\n';
+    }
+
+    // Distributions don't fit the per-image columns, so they go in a sibling file
+    std::string base = reportPath.substr(0, reportPath.size() - Utils::getFileExtension(reportPath).size());
+    std::string summaryPath = base + "_summary.csv";
+    std::ofstream summaryFile(summaryPath);
+    if (!summaryFile.is_open()) {
+        Utils::logError("Could not write quality summary: ", summaryPath);
+        return false;
+    }
+
+    summaryFile << std::setprecision(10);
+    summaryFile << "metric,count,mean,stddev,min,p5,p50,p95,p99,max\n";
+    for (const auto& metric : summarize()) {
+        const auto& s = metric.second;
+        summaryFile << metric.first << ',' << s.count << ',' << s.mean << ',' << s.stddev << ','
+                    << s.min << ',' << s.p5 << ',' << s.p50 << ',' << s.p95 << ',' << s.p99 << ',' << s.max << '\n';
+    }
+
+    Utils::logInfo("Quality report written to ", reportPath, " and ", summaryPath);
+    return file.good() && summaryFile.good();
+}
+
+bool QualityReport::writeJson(const std::string& reportPath) const {
+    std::ofstream file(reportPath);
+    if (!file.is_open()) {
+        Utils::logError("Could not write quality report: ", reportPath);
+        return false;
+    }
+
+    size_t scored = std::count_if(entries_.begin(), entries_.end(), [](const Entry& e) { return e.ok; });
+
+    file << std::setprecision(10);
+    file << "{\n";
+    file << "  \"images\": " << entries_.size() << ",\n";
+    file << "  \"scored\": " << scored << ",\n";
+    file << "  \"threads\": " << threads_ << ",\n";
+    file << "  \"wall_ms\": " << wallMs_ << ",\n";
+    file << "  \"images_per_second\": " << (wallMs_ > 0.0 ? entries_.size() * 1000.0 / wallMs_ : 0.0) << ",\n";
+
+    file << "  \"summary\": {\n";
+    auto summary = summarize();
+    for (size_t i = 0; i < summary.size(); ++i) {
+        const auto& s = summary[i].second;
+        file << "    " << Utils::jsonString(summary[i].first) << ": {\"count\": " << s.count
+             << ", \"mean\": " << s.mean << ", \"stddev\": " << s.stddev
+             << ", \"min\": " << s.min << ", \"p5\": " << s.p5 << ", \"p50\": " << s.p50
+             << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}"
+             << (i + 1 < summary.size() ? ",\n" : "\n");
+    }
+    file << "  },\n";
+
+    file << "  \"entries\": [\n";
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        const auto& e = entries_[i];
+        file << "    {\"name\": " << Utils::jsonString(e.name)
+             << ", \"input\": " << Utils::jsonString(e.inputPath)
+             << ", \"output\": " << Utils::jsonString(e.outputPath)
+             << ", \"ok\": " << (e.ok ? "true" : "false");
+        if (e.ok) {
+            file << ", \"input_size\": [" << e.inputSize.width << ", " << e.inputSize.height << "]"
+                 << ", \"output_size\": [" << e.outputSize.width << ", " << e.outputSize.height << "]"
+                 << ", \"psnr\": " << e.psnr << ", \"ssim\": " << e.ssim << ", \"msssim\": " << e.msssim
+                 << ", \"sharpness_original\": " << e.sharpnessOriginal
+                 << ", \"sharpness_enhanced\": " << e.sharpnessEnhanced
+                 << ", \"timings_ms\": {\"decode\": " << e.decodeMs << ", \"resample\": " << e.resampleMs
+                 << ", \"psnr\": " << e.psnrMs << ", \"ssim\": " << e.ssimMs
+                 << ", \"sharpness\": " << e.sharpnessMs << ", \"total\": " << e.totalMs << "}";
+        } else {
+            file << ", \"error\": " << Utils::jsonString(e.error);
+        }
+        file << "}" << (i + 1 < entries_.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n";
+    file << "}\n";
+
+    Utils::logInfo("Quality report written to ", reportPath);
+    return file.good();
+}
+
+void QualityReport::logSummary() const {
+    size_t scored = std::count_if(entries_.begin(), entries_.end(), [](const Entry& e) { return e.ok; });
+
+    Utils::logInfo("=== Quality Report ===");
+    Utils::logInfo("Image pairs: ", entries_.size(), " (", scored, " scored)");
+    Utils::logInfo("Workers: ", threads_);
+    if (wallMs_ > 0.0) {
+        Utils::logInfo("Throughput: ", entries_.size() * 1000.0 / wallMs_, " images/sec");
+    }
+    for (const auto& metric : summarize()) {
+        const auto& s = metric.second;
+        if (s.count == 0) continue;
+        Utils::logInfo(metric.first, ": mean ", s.mean, ", p5 ", s.p5, ", p50 ", s.p50, ", p95 ", s.p95);
+    }
+    Utils::logInfo("======================");
+}
@@ -0,0 +1,308 @@
+#include "ssim_engine.h"
+#include "memory_tracker.h"
+#include "tracer.h"
+#include "utils.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Stabilising constants for 8-bit dynamic range: (0.01 * 255)^2 and (0.03 * 255)^2
+    const double C1 = 6.5025;
+    const double C2 = 58.5225;
+
+    // Per-scale exponents from Wang, Simoncelli and Bovik (2003)
+    const double kMsSsimWeights[] = {0.0448, 0.2856, 0.3001, 0.2363, 0.1333};
+    const int kMsSsimScales = 5;
+
+    // Moments accumulated per window: x, y, x^2, y^2, xy
+    const int kMoments = 5;
+
+    // Reflect-101 border, matching cv::GaussianBlur's default
+    inline int reflect101(int i, int n) {
+        if (n == 1) return 0;
+        while (i < 0 || i >= n) {
+            i = i < 0 ? -i : 2 * n - 2 - i;
+        }
+        return i;
+    }
+
+    inline void addRowMoments(const float* x, const float* y, int width, double sign, double* sums) {
+        for (int c = 0; c < width; ++c) {
+            double a = x[c], b = y[c];
+            sums[c] += sign * a;
+            sums[width + c] += sign * b;
+            sums[2 * width + c] += sign * a * a;
+            sums[3 * width + c] += sign * b * b;
+            sums[4 * width + c] += sign * a * b;
+        }
+    }
+
+    inline void scorePixel(const double* m, double& ssimSum, double& csSum) {
+        double mu1 = m[0], mu2 = m[1];
+        double var1 = m[2] - mu1 * mu1;
+        double var2 = m[3] - mu2 * mu2;
+        double cov = m[4] - mu1 * mu2;
+
+        double cs = (2.0 * cov + C2) / (var1 + var2 + C2);
+        double luminance = (2.0 * mu1 * mu2 + C1) / (mu1 * mu1 + mu2 * mu2 + C1);
+        ssimSum += luminance * cs;
+        csSum += cs;
+    }
+}
+
+double SSIMEngine::ssim(const cv::Mat& first, const cv::Mat& second) {
+    return ssim(first, second, Options());
+}
+
+double SSIMEngine::ssim(const cv::Mat& first, const cv::Mat& second, const Options& options) {
+    if (first.empty() || second.empty()) return 0.0;
+    if (first.size() != second.size() || first.channels() != second.channels()) return 0.0;
+
+    try {
+        std::vector<cv::Mat> planes1 = preparePlanes(first, options.lumaOnly);
+        std::vector<cv::Mat> planes2 = preparePlanes(second, options.lumaOnly);
+
+        double total = 0.0;
+        for (size_t i = 0; i < planes1.size(); ++i) {
+            total += scorePlane(planes1[i], planes2[i], options).ssim;
+        }
+        return total / planes1.size();
+
+    } catch (const std::exception& e) {
+        Utils::logError("Exception calculating SSIM: ", e.what());
+        return 0.0;
+    }
+}
+
+double SSIMEngine::msssim(const cv::Mat& first, const cv::Mat& second) {
+    return msssim(first, second, Options());
+}
+
+double SSIMEngine::msssim(const cv::Mat& first, const cv::Mat& second, const Options& options) {
+    if (first.empty() || second.empty()) return 0.0;
+    if (first.size() != second.size() || first.channels() != second.channels()) return 0.0;
+
+    try {
+        std::vector<cv::Mat> planes1 = preparePlanes(first, options.lumaOnly);
+        std::vector<cv::Mat> planes2 = preparePlanes(second, options.lumaOnly);
+        const int windowSize = static_cast<int>(windowWeights(options).size());
+
+        double total = 0.0;
+        for (size_t i = 0; i < planes1.size(); ++i) {
+            cv::Mat x = planes1[i], y = planes2[i];
+            double logProduct = 0.0, weightSum = 0.0;
+
+            for (int scale = 0; scale < kMsSsimScales; ++scale) {
+                Score score = scorePlane(x, y, options);
+                bool last = scale == kMsSsimScales - 1 || std::min(x.cols, x.rows) / 2 < windowSize;
+
+                // Coarser scales contribute contrast-structure only; the coarsest also adds luminance
+                double term = std::max(last ? score.ssim : score.cs, 1e-12);
+                logProduct += kMsSsimWeights[scale] * std::log(term);
+                weightSum += kMsSsimWeights[scale];
+                if (last) break;
+
+                cv::resize(x, x, cv::Size(x.cols / 2, x.rows / 2), 0, 0, cv::INTER_AREA);
+                cv::resize(y, y, x.size(), 0, 0, cv::INTER_AREA);
+            }
+            total += std::exp(logProduct / weightSum);
+        }
+        return total / planes1.size();
+
+    } catch (const std::exception& e) {
+        Utils::logError("Exception calculating MS-SSIM: ", e.what());
+        return 0.0;
+    }
+}
+
+double SSIMEngine::ssimInRegions(const cv::Mat& first, const cv::Mat& second, const std::vector<cv::Rect>& regions) {
+    return ssimInRegions(first, second, regions, Options());
+}
+
+double SSIMEngine::ssimInRegions(const cv::Mat& first, const cv::Mat& second, const std::vector<cv::Rect>& regions,
+                                 const Options& options) {
+    if (first.empty() || second.empty() || first.size() != second.size()) return 0.0;
+
+    const cv::Rect bounds(0, 0, first.cols, first.rows);
+    double weighted = 0.0, area = 0.0;
+    for (const auto& region : regions) {
+        cv::Rect clipped = region & bounds;
+        if (clipped.area() == 0) continue;
+
+        weighted += ssim(first(clipped), second(clipped), options) * clipped.area();
+        area += clipped.area();
+    }
+    return area > 0.0 ? weighted / area : 0.0;
+}
+
+std::vector<cv::Mat> SSIMEngine::preparePlanes(const cv::Mat& image, bool lumaOnly) {
+    cv::Mat source = image;
+    if (lumaOnly && image.channels() == 3) {
+        cv::cvtColor(image, source, cv::COLOR_BGR2GRAY);
+    } else if (lumaOnly && image.channels() == 4) {
+        cv::cvtColor(image, source, cv::COLOR_BGRA2GRAY);
+    }
+
+    cv::Mat floating;
+    source.convertTo(floating, CV_32F);
+
+    std::vector<cv::Mat> planes;
+    if (floating.channels() == 1) {
+        planes.push_back(floating);
+    } else {
+        cv::split(floating, planes);
+    }
+    return planes;
+}
+
+std::vector<float> SSIMEngine::windowWeights(const Options& options) {
+    const int size = std::max(1, options.windowSize | 1);
+    const int radius = size / 2;
+
+    std::vector<float> weights(size, 1.0f / size);
+    if (options.window == GAUSSIAN) {
+        double sum = 0.0;
+        for (int i = 0; i < size; ++i) {
+            double d = i - radius;
+            weights[i] = static_cast<float>(std::exp(-d * d / (2.0 * options.sigma * options.sigma)));
+            sum += weights[i];
+        }
+        for (auto& w : weights) {
+            w = static_cast<float>(w / sum);
+        }
+    }
+    return weights;
+}
+
+SSIMEngine::Score SSIMEngine::scorePlane(const cv::Mat& first, const cv::Mat& second, const Options& options) {
+    Score score;
+    const int width = first.cols;
+    const int height = first.rows;
+    if (width == 0 || height == 0) return score;
+
+    const std::vector<float> weights = windowWeights(options);
+    const int size = static_cast<int>(weights.size());
+    const int radius = size / 2;
+    const bool box = options.window == BOX;
+    const int bandRows = std::max(1, options.bandRows);
+    const int bandCount = (height + bandRows - 1) / bandRows;
+
+    std::vector<Score> bandScores(bandCount);
+
+    const MemoryTracker::Context memoryContext = MemoryTracker::currentContext();
+    cv::parallel_for_(cv::Range(0, bandCount), [&](const cv::Range& range) {
+        MemoryTracker::ContextScope memoryScope(memoryContext);
+        Tracer::Span traceSpan("SSIM bands", "opencv");
+        // Vertical window moments for one output row, padded for the horizontal pass
+        const int padded = width + 2 * radius;
+        std::vector<double> rowMoments(static_cast<size_t>(kMoments) * padded);
+        // Box windows keep running column sums instead of re-reading every window row
+        std::vector<double> columnSums(box ? static_cast<size_t>(kMoments) * width : 0);
+        double m[kMoments];
+
+        for (int band = range.start; band < range.end; ++band) {
+            const int y0 = band * bandRows;
+            const int y1 = std::min(height, y0 + bandRows);
+            double ssimSum = 0.0, csSum = 0.0;
+
+            if (box) {
+                std::fill(columnSums.begin(), columnSums.end(), 0.0);
+                for (int k = -radius; k <= radius; ++k) {
+                    int src = reflect101(y0 + k, height);
+                    addRowMoments(first.ptr<float>(src), second.ptr<float>(src), width, 1.0, columnSums.data());
+                }
+            }
+
+            for (int row = y0; row < y1; ++row) {
+                if (box) {
+                    if (row > y0) {
+                        int enter = reflect101(row + radius, height);
+                        int leave = reflect101(row - radius - 1, height);
+                        addRowMoments(first.ptr<float>(enter), second.ptr<float>(enter), width, 1.0, columnSums.data());
+                        addRowMoments(first.ptr<float>(leave), second.ptr<float>(leave), width, -1.0, columnSums.data());
+                    }
+                    for (int k = 0; k < kMoments; ++k) {
+                        const double* sums = columnSums.data() + static_cast<size_t>(k) * width;
+                        double* dst = rowMoments.data() + static_cast<size_t>(k) * padded + radius;
+                        for (int c = 0; c < width; ++c) {
+                            dst[c] = sums[c] / size;
+                        }
+                    }
+                } else {
+                    std::fill(rowMoments.begin(), rowMoments.end(), 0.0);
+                    double* mx = rowMoments.data() + radius;
+                    double* my = mx + padded;
+                    double* mxx = my + padded;
+                    double* myy = mxx + padded;
+                    double* mxy = myy + padded;
+                    for (int k = -radius; k <= radius; ++k) {
+                        int src = reflect101(row + k, height);
+                        const float* x = first.ptr<float>(src);
+                        const float* y = second.ptr<float>(src);
+                        const double w = weights[k + radius];
+                        for (int c = 0; c < width; ++c) {
+                            double a = x[c], b = y[c];
+                            mx[c] += w * a;
+                            my[c] += w * b;
+                            mxx[c] += w * a * a;
+                            myy[c] += w * b * b;
+                            mxy[c] += w * a * b;
+                        }
+                    }
+                }
+
+                // Reflect each moment row into its horizontal padding
+                for (int k = 0; k < kMoments; ++k) {
+                    double* line = rowMoments.data() + static_cast<size_t>(k) * padded + radius;
+                    for (int i = 1; i <= radius; ++i) {
+                        line[-i] = line[reflect101(-i, width)];
+                        line[width - 1 + i] = line[reflect101(width - 1 + i, width)];
+                    }
+                }
+
+                if (box) {
+                    double running[kMoments];
+                    for (int k = 0; k < kMoments; ++k) {
+                        const double* line = rowMoments.data() + static_cast<size_t>(k) * padded;
+                        running[k] = 0.0;
+                        for (int i = 0; i < size; ++i) running[k] += line[i];
+                    }
+                    for (int c = 0; c < width; ++c) {
+                        for (int k = 0; k < kMoments; ++k) {
+                            m[k] = running[k] / size;
+                        }
+                        scorePixel(m, ssimSum, csSum);
+                        if (c + 1 < width) {
+                            for (int k = 0; k < kMoments; ++k) {
+                                const double* line = rowMoments.data() + static_cast<size_t>(k) * padded;
+                                running[k] += line[c + size] - line[c];
+                            }
+                        }
+                    }
+                } else {
+                    for (int c = 0; c < width; ++c) {
+                        for (int k = 0; k < kMoments; ++k) {
+                            const double* line = rowMoments.data() + static_cast<size_t>(k) * padded + c;
+                            double sum = 0.0;
+                            for (int i = 0; i < size; ++i) sum += weights[i] * line[i];
+                            m[k] = sum;
+                        }
+                        scorePixel(m, ssimSum, csSum);
+                    }
+                }
+            }
+
+            bandScores[band].ssim = ssimSum;
+            bandScores[band].cs = csSum;
+        }
+    });
+
+    const double pixels = static_cast<double>(width) * height;
+    for (const auto& band : bandScores) {
+        score.ssim += band.ssim;
+        score.cs += band.cs;
+    }
+    score.ssim /= pixels;
+    score.cs /= pixels;
+    return score;
+}
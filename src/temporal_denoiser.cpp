@@ -0,0 +1,139 @@
+#include "temporal_denoiser.h"
+#include "utils.h"
+#include <algorithm>
+
+namespace {
+    // Largest proxy side used for shift estimation
+    const double kProxySide = 256.0;
+    // Phase correlation peaks below this are treated as failed alignment
+    const double kMinAlignmentResponse = 0.1;
+}
+
+TemporalDenoiser::TemporalDenoiser(int windowSize, Method method, float strength)
+    : windowSize_(std::max(1, windowSize))
+    , method_(method)
+    , strength_(strength) {
+}
+
+bool TemporalDenoiser::denoise(const cv::Mat& frame, cv::Mat& output) {
+    output = frame;
+    if (frame.empty()) return false;
+
+    try {
+        double scale = 1.0;
+        cv::Mat proxy = makeProxy(frame, scale);
+        if (hanningWindow_.size() != proxy.size()) {
+            cv::createHanningWindow(hanningWindow_, proxy.size(), CV_32F);
+        }
+
+        // Shift every buffered frame onto the current one; frames that can't be aligned are left out
+        std::vector<cv::Mat> aligned;
+        for (const auto& past : frames_) {
+            if (past.image.size() != frame.size() || past.image.type() != frame.type()) continue;
+
+            double response = 0.0;
+            cv::Point2d shift = cv::phaseCorrelate(past.proxy, proxy, hanningWindow_, &response);
+            if (response < kMinAlignmentResponse) continue;
+
+            cv::Mat translation = (cv::Mat_<double>(2, 3) << 1.0, 0.0, shift.x / scale, 0.0, 1.0, shift.y / scale);
+            cv::Mat warped;
+            cv::warpAffine(past.image, warped, translation, frame.size(), cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+            aligned.push_back(warped);
+        }
+
+        // Raw frames go into the ring so denoising never feeds back on itself
+        frames_.push_back({frame, proxy});
+        while (static_cast<int>(frames_.size()) > windowSize_ - 1) {
+            frames_.pop_front();
+        }
+
+        if (aligned.empty()) return false;
+
+        if (method_ == NLM_MULTI && aligned.size() >= 2) {
+            output = nlmOfStack(frame, aligned);
+        } else {
+            output = meanOfStack(frame, aligned);
+        }
+        return true;
+
+    } catch (const std::exception& e) {
+        Utils::logError("Exception in temporal denoising: ", e.what());
+        output = frame;
+        return false;
+    }
+}
+
+void TemporalDenoiser::reset() {
+    frames_.clear();
+}
+
+cv::Mat TemporalDenoiser::makeProxy(const cv::Mat& frame, double& scale) const {
+    cv::Mat gray;
+    if (frame.channels() > 1) {
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = frame;
+    }
+
+    scale = std::min(1.0, kProxySide / std::max(frame.cols, frame.rows));
+    cv::Mat proxy;
+    if (scale < 1.0) {
+        cv::resize(gray, proxy, cv::Size(), scale, scale, cv::INTER_AREA);
+    } else {
+        proxy = gray;
+    }
+
+    proxy.convertTo(proxy, CV_32F);
+    return proxy;
+}
+
+cv::Mat TemporalDenoiser::meanOfStack(const cv::Mat& frame, const std::vector<cv::Mat>& aligned) const {
+    // Pixels that differ by more than a few noise levels are motion the shift didn't explain
+    const double motionThreshold = 3.0 * strength_;
+
+    cv::Mat sum, weight = cv::Mat::ones(frame.size(), CV_32F);
+    frame.convertTo(sum, CV_32F);
+
+    for (const auto& past : aligned) {
+        cv::Mat diff, mask, pastFloat;
+        cv::absdiff(past, frame, diff);
+        if (diff.channels() > 1) {
+            cv::cvtColor(diff, diff, cv::COLOR_BGR2GRAY);
+        }
+        cv::threshold(diff, mask, motionThreshold, 255, cv::THRESH_BINARY_INV);
+
+        past.convertTo(pastFloat, CV_32F);
+        cv::add(sum, pastFloat, sum, mask);
+        cv::add(weight, cv::Scalar(1.0), weight, mask);
+    }
+
+    if (frame.channels() > 1) {
+        std::vector<cv::Mat> planes(frame.channels(), weight);
+        cv::merge(planes, weight);
+    }
+
+    cv::Mat result;
+    cv::divide(sum, weight, sum);
+    sum.convertTo(result, frame.type());
+    return result;
+}
+
+cv::Mat TemporalDenoiser::nlmOfStack(const cv::Mat& frame, const std::vector<cv::Mat>& aligned) const {
+    // The Multi variants need an odd window centred on the target, so the
+    // current frame goes in the middle of an even number of aligned frames
+    size_t count = aligned.size() - aligned.size() % 2;
+    std::vector<cv::Mat> stack(aligned.end() - count, aligned.end() - count / 2);
+    stack.push_back(frame);
+    stack.insert(stack.end(), aligned.end() - count / 2, aligned.end());
+
+    int target = static_cast<int>(count / 2);
+    int window = static_cast<int>(stack.size());
+
+    cv::Mat result;
+    if (frame.channels() == 1) {
+        cv::fastNlMeansDenoisingMulti(stack, result, target, window, strength_);
+    } else {
+        cv::fastNlMeansDenoisingColoredMulti(stack, result, target, window, strength_, strength_);
+    }
+    return result;
+}
@@ -0,0 +1,145 @@
+#include "tracer.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Tracer::enabled_(false);
+
+namespace {
+    struct Event {
+        std::string name;
+        const char* category;
+        std::string image;
+        long long startUs;
+        long long durationUs;
+    };
+
+    // Only the owning thread appends; the mutex is uncontended until write() reads it
+    struct ThreadBuffer {
+        int tid = 0;
+        std::string name;
+        std::mutex mutex;
+        std::vector<Event> events;
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;  // outlive their threads so the trace keeps them
+    std::string tracePath;
+    std::chrono::steady_clock::time_point traceStart;
+
+    thread_local ThreadBuffer* localBuffer = nullptr;
+    thread_local std::string currentImage;
+
+    ThreadBuffer& threadBuffer() {
+        if (!localBuffer) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffers.push_back(std::make_unique<ThreadBuffer>());
+            localBuffer = buffers.back().get();
+            localBuffer->tid = static_cast<int>(buffers.size());
+            localBuffer->events.reserve(1024);
+        }
+        return *localBuffer;
+    }
+
+    long long sinceStartUs(std::chrono::steady_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time - traceStart).count();
+    }
+
+    void writeAtExit() {
+        Tracer::write();
+    }
+}
+
+void Tracer::enable(const std::string& path) {
+    static std::once_flag once;
+    std::call_once(once, [&path]() {
+        tracePath = path;
+        traceStart = std::chrono::steady_clock::now();
+        std::atexit(writeAtExit);
+        enabled_.store(true, std::memory_order_release);
+        setThreadName("main");
+        Utils::logInfo("Tracing to ", path);
+    });
+}
+
+bool Tracer::write() {
+    if (!isEnabled()) return false;
+
+    std::ofstream file(tracePath);
+    if (!file.is_open()) {
+        Utils::logError("Could not write trace: ", tracePath);
+        return false;
+    }
+
+    size_t eventCount = 0;
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    file << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"face_enhancer\"}}";
+
+    std::lock_guard<std::mutex> registryLock(registryMutex);
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        std::string threadName = buffer->name.empty() ? "thread " + std::to_string(buffer->tid) : buffer->name;
+        file << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+             << ", \"args\": {\"name\": " << Utils::jsonString(threadName) << "}}";
+
+        for (const auto& event : buffer->events) {
+            file << ",\n  {\"name\": " << Utils::jsonString(event.name) << ", \"cat\": \"" << event.category
+                 << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->tid
+                 << ", \"ts\": " << event.startUs << ", \"dur\": " << event.durationUs;
+            if (!event.image.empty()) {
+                file << ", \"args\": {\"image\": " << Utils::jsonString(event.image) << "}";
+            }
+            file << "}";
+        }
+        eventCount += buffer->events.size();
+    }
+    file << "\n]}\n";
+
+    Utils::logInfo("Trace with ", eventCount, " spans written to ", tracePath);
+    return file.good();
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    if (!isEnabled()) return;
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.name = name;
+}
+
+void Tracer::recordCompleted(const std::string& name, double durationMs, const char* category) {
+    if (!isEnabled()) return;
+    auto end = std::chrono::steady_clock::now();
+    auto start = end - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(std::max(0.0, durationMs)));
+    record(name, category, start, end);
+}
+
+void Tracer::Span::finish() {
+    record(name_, category_, start_, std::chrono::steady_clock::now());
+}
+
+Tracer::ImageScope::ImageScope(const std::string& image)
+    : active_(isEnabled()) {
+    if (active_) {
+        previous_ = currentImage;
+        currentImage = image;
+    }
+}
+
+Tracer::ImageScope::~ImageScope() {
+    if (active_) currentImage = previous_;
+}
+
+void Tracer::record(const std::string& name, const char* category,
+                    std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    ThreadBuffer& buffer = threadBuffer();
+    long long startUs = sinceStartUs(start);
+    long long durationUs = std::max(0LL, sinceStartUs(end) - startUs);
+
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back({name, category, currentImage, startUs, durationUs});
+}
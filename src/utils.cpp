@@ -1,10 +1,13 @@
 #include "utils.h"
+#include "logger.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <filesystem>
 #include <algorithm>
 #include <cctype>
+#include <climits>
+#include <cmath>
 #include <ctime>
 #include <iomanip>
 
@@ -14,10 +17,14 @@
 #else
 #include <sys/resource.h>
 #include <sys/utsname.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 // Initialize static members
-Utils::LogLevel Utils::currentLogLevel_ = Utils::LOG_INFO;
+std::atomic<Utils::LogLevel> Utils::currentLogLevel_(Utils::LOG_INFO);
 std::vector<std::string> Utils::imageExtensions_ = {
     ".jpg", ".jpeg", ".png", ".bmp", ".tiff", ".tif", ".webp", ".jp2"
 };
@@ -27,7 +34,7 @@ bool Utils::createDirectory(const std::string& path) {
     try {
         return std::filesystem::create_directories(path);
     } catch (const std::exception& e) {
-        logError("Failed to create directory " + path + ": " + e.what());
+        logError("Failed to create directory ", path, ": ", e.what());
         return false;
     }
 }
@@ -36,7 +43,7 @@ bool Utils::directoryExists(const std::string& path) {
     try {
         return std::filesystem::exists(path) && std::filesystem::is_directory(path);
     } catch (const std::exception& e) {
-        logError("Error checking directory existence: " + std::string(e.what()));
+        logError("Error checking directory existence: ", e.what());
         return false;
     }
 }
@@ -45,7 +52,7 @@ bool Utils::fileExists(const std::string& path) {
     try {
         return std::filesystem::exists(path) && std::filesystem::is_regular_file(path);
     } catch (const std::exception& e) {
-        logError("Error checking file existence: " + std::string(e.what()));
+        logError("Error checking file existence: ", e.what());
         return false;
     }
 }
@@ -55,7 +62,7 @@ std::vector<std::string> Utils::listFiles(const std::string& directory, const st
     
     try {
         if (!directoryExists(directory)) {
-            logWarning("Directory does not exist: " + directory);
+            logWarning("Directory does not exist: ", directory);
             return files;
         }
 
@@ -71,7 +78,7 @@ std::vector<std::string> Utils::listFiles(const std::string& directory, const st
         
         std::sort(files.begin(), files.end());
     } catch (const std::exception& e) {
-        logError("Error listing files in directory " + directory + ": " + e.what());
+        logError("Error listing files in directory ", directory, ": ", e.what());
     }
     
     return files;
@@ -89,7 +96,7 @@ std::string Utils::getBasename(const std::string& path) {
     try {
         return std::filesystem::path(path).filename().string();
     } catch (const std::exception& e) {
-        logError("Error getting basename: " + std::string(e.what()));
+        logError("Error getting basename: ", e.what());
         return path;
     }
 }
@@ -100,11 +107,34 @@ std::string Utils::joinPath(const std::string& path1, const std::string& path2)
         std::filesystem::path p2(path2);
         return (p1 / p2).string();
     } catch (const std::exception& e) {
-        logError("Error joining paths: " + std::string(e.what()));
+        logError("Error joining paths: ", e.what());
         return path1 + "/" + path2;
     }
 }
 
+void Utils::prefetchFile(const std::string& path) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    
+    // Starts asynchronous readahead so a later mmap or read finds the pages cached
+#if defined(__APPLE__)
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        struct radvisory advice;
+        advice.ra_offset = 0;
+        advice.ra_count = static_cast<int>(std::min<off_t>(info.st_size, INT_MAX));
+        ::fcntl(fd, F_RDADVISE, &advice);
+    }
+#elif defined(__linux__)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+    ::close(fd);
+#else
+    (void)path;
+#endif
+}
+
 // String utilities
 std::string Utils::toLowerCase(const std::string& str) {
     std::string result = str;
@@ -148,15 +178,42 @@ bool Utils::startsWith(const std::string& str, const std::string& prefix) {
     return str.compare(0, prefix.length(), prefix) == 0;
 }
 
+std::string Utils::jsonString(const std::string& value) {
+    std::ostringstream out;
+    out << '"';
+    for (unsigned char c : value) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (c < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
 // Time and performance utilities
 std::string Utils::getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
+    return formatTimestamp(std::chrono::system_clock::now());
+}
+
+std::string Utils::formatTimestamp(const std::chrono::system_clock::time_point& time) {
+    auto time_t = std::chrono::system_clock::to_time_t(time);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
+        time.time_since_epoch()) % 1000;
+
+    // std::localtime shares one buffer between threads; the log writer and workers both get here
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &time_t);
+#else
+    localtime_r(&time_t, &local);
+#endif
+
     std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+    ss << std::put_time(&local, "%Y-%m-%d %H:%M:%S");
     ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
     
     return ss.str();
@@ -169,7 +226,7 @@ double Utils::getElapsedTime(const std::chrono::high_resolution_clock::time_poin
 }
 
 void Utils::printProcessingTime(const std::string& operation, double timeMs) {
-    logInfo(operation + " completed in " + std::to_string(timeMs) + " ms");
+    logInfo(operation, " completed in ", timeMs, " ms");
 }
 
 // Image validation utilities
@@ -182,6 +239,10 @@ bool Utils::isValidImageDimensions(const cv::Mat& image, int minWidth, int minHe
     return !image.empty() && image.cols >= minWidth && image.rows >= minHeight;
 }
 
+bool Utils::isValidImageDimensions(const cv::Size& size, int minWidth, int minHeight) {
+    return size.width >= minWidth && size.height >= minHeight;
+}
+
 std::string Utils::getImageInfo(const cv::Mat& image) {
     if (image.empty()) {
         return "Empty image";
@@ -205,10 +266,33 @@ size_t Utils::getMemoryUsage() {
         return pmc.WorkingSetSize;
     }
     return 0;
+#else
+    // Second field of statm is resident pages; where it is missing, the peak is the best we have
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    if (statm >> totalPages >> residentPages) {
+        return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+    return getPeakMemoryUsage();
+#endif
+}
+
+size_t Utils::getPeakMemoryUsage() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        return pmc.PeakWorkingSetSize;
+    }
+    return 0;
 #else
     struct rusage usage;
     if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss;  // already bytes on macOS
+#else
         return usage.ru_maxrss * 1024; // Convert KB to bytes on Linux
+#endif
     }
     return 0;
 #endif
@@ -235,27 +319,74 @@ void Utils::printSystemInfo() {
 #ifdef _WIN32
     SYSTEM_INFO sysInfo;
     GetSystemInfo(&sysInfo);
-    logInfo("Processor count: " + std::to_string(sysInfo.dwNumberOfProcessors));
+    logInfo("Processor count: ", sysInfo.dwNumberOfProcessors);
     
     MEMORYSTATUSEX memInfo;
     memInfo.dwLength = sizeof(MEMORYSTATUSEX);
     if (GlobalMemoryStatusEx(&memInfo)) {
-        logInfo("Total physical memory: " + formatFileSize(memInfo.ullTotalPhys));
-        logInfo("Available physical memory: " + formatFileSize(memInfo.ullAvailPhys));
+        logInfo("Total physical memory: ", formatFileSize(memInfo.ullTotalPhys));
+        logInfo("Available physical memory: ", formatFileSize(memInfo.ullAvailPhys));
     }
 #else
     struct utsname unameData;
     if (uname(&unameData) == 0) {
-        logInfo("System: " + std::string(unameData.sysname));
-        logInfo("Machine: " + std::string(unameData.machine));
-        logInfo("Version: " + std::string(unameData.version));
+        logInfo("System: ", unameData.sysname);
+        logInfo("Machine: ", unameData.machine);
+        logInfo("Version: ", unameData.version);
     }
 #endif
 
-    logInfo("Current memory usage: " + formatFileSize(getMemoryUsage()));
+    logInfo("Current memory usage: ", formatFileSize(getMemoryUsage()));
+    logInfo("Peak memory usage: ", formatFileSize(getPeakMemoryUsage()));
     logInfo("========================");
 }
 
+// Mapped file implementation
+Utils::MappedFile::MappedFile(const std::string& path) : data_(nullptr), size_(0) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        logError("Failed to open file for mapping: ", path);
+        return;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            // Decoders read front to back: aggressive readahead, pages dropped behind
+            madvise(mapping, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            data_ = static_cast<const unsigned char*>(mapping);
+            size_ = static_cast<size_t>(info.st_size);
+        } else {
+            logError("Failed to map file: ", path);
+        }
+    }
+    ::close(fd);  // the mapping keeps its own reference
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        logError("Failed to open file for mapping: ", path);
+        return;
+    }
+    
+    buffer_.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!buffer_.empty() && file.read(reinterpret_cast<char*>(buffer_.data()), buffer_.size())) {
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+#endif
+}
+
+Utils::MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (data_) {
+        munmap(const_cast<unsigned char*>(data_), size_);
+    }
+#endif
+}
+
 // Progress Bar implementation
 Utils::ProgressBar::ProgressBar(int total, const std::string& prefix) 
     : total_(total), prefix_(prefix), startTime_(std::chrono::high_resolution_clock::now()) {
@@ -268,10 +399,10 @@ void Utils::ProgressBar::update(int current) {
 
 void Utils::ProgressBar::finish() {
     printBar(total_);
-    std::cout << std::endl;
+    writeToLogStream("\n");
     
     double elapsed = getElapsedTime(startTime_);
-    logInfo("Total time: " + std::to_string(elapsed) + " ms");
+    logInfo("Total time: ", elapsed, " ms");
 }
 
 void Utils::ProgressBar::printBar(int current) {
@@ -279,14 +410,46 @@ void Utils::ProgressBar::printBar(int current) {
     float progress = static_cast<float>(current) / total_;
     int pos = static_cast<int>(barWidth * progress);
     
-    std::cout << "\r" << prefix_ << " [";
+    std::ostringstream bar;
+    bar << "\r" << prefix_ << " [";
     for (int i = 0; i < barWidth; ++i) {
-        if (i < pos) std::cout << "=";
-        else if (i == pos) std::cout << ">";
-        else std::cout << " ";
+        if (i < pos) bar << "=";
+        else if (i == pos) bar << ">";
+        else bar << " ";
     }
-    std::cout << "] " << int(progress * 100.0) << "% (" << current << "/" << total_ << ")";
-    std::cout.flush();
+    bar << "] " << int(progress * 100.0) << "% (" << current << "/" << total_ << ")";
+    writeToLogStream(bar.str());
+}
+
+Utils::SampleStats Utils::SampleStats::of(std::vector<double> values) {
+    SampleStats stats;
+    if (values.empty()) return stats;
+
+    std::sort(values.begin(), values.end());
+    stats.count = values.size();
+    stats.min = values.front();
+    stats.max = values.back();
+
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    stats.mean = sum / values.size();
+
+    double squares = 0.0;
+    for (double v : values) squares += (v - stats.mean) * (v - stats.mean);
+    stats.stddev = std::sqrt(squares / values.size());
+
+    // Linear interpolation between closest ranks
+    auto percentile = [&values](double p) {
+        double rank = p * (values.size() - 1);
+        size_t lower = static_cast<size_t>(rank);
+        size_t upper = std::min(lower + 1, values.size() - 1);
+        return values[lower] + (rank - lower) * (values[upper] - values[lower]);
+    };
+    stats.p5 = percentile(0.05);
+    stats.p50 = percentile(0.50);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+    return stats;
 }
 
 // Configuration utilities
@@ -296,7 +459,7 @@ Utils::Config Utils::Config::loadFromFile(const std::string& configPath) {
     try {
         std::ifstream file(configPath);
         if (!file.is_open()) {
-            logWarning("Could not open config file: " + configPath + ". Using defaults.");
+            logWarning("Could not open config file: ", configPath, ". Using defaults.");
             return config;
         }
         
@@ -321,9 +484,9 @@ Utils::Config Utils::Config::loadFromFile(const std::string& configPath) {
             else if (key == "super_resolution_scale") config.superResolutionScale = std::stoi(value);
         }
         
-        logInfo("Configuration loaded from: " + configPath);
+        logInfo("Configuration loaded from: ", configPath);
     } catch (const std::exception& e) {
-        logError("Error loading config: " + std::string(e.what()));
+        logError("Error loading config: ", e.what());
     }
     
     return config;
@@ -333,7 +496,7 @@ bool Utils::Config::saveToFile(const std::string& configPath) const {
     try {
         std::ofstream file(configPath);
         if (!file.is_open()) {
-            logError("Could not open config file for writing: " + configPath);
+            logError("Could not open config file for writing: ", configPath);
             return false;
         }
         
@@ -347,55 +510,59 @@ bool Utils::Config::saveToFile(const std::string& configPath) const {
         file << "noise_reduction=" << noiseReduction << "\n";
         file << "super_resolution_scale=" << superResolutionScale << "\n";
         
-        logInfo("Configuration saved to: " + configPath);
+        logInfo("Configuration saved to: ", configPath);
         return true;
     } catch (const std::exception& e) {
-        logError("Error saving config: " + std::string(e.what()));
+        logError("Error saving config: ", e.what());
         return false;
     }
 }
 
 void Utils::Config::printConfig() const {
     logInfo("=== Current Configuration ===");
-    logInfo("Input path: " + inputPath);
-    logInfo("Output path: " + outputPath);
-    logInfo("Batch mode: " + std::string(batchMode ? "enabled" : "disabled"));
-    logInfo("Verbose: " + std::string(verbose ? "enabled" : "disabled"));
-    logInfo("Show preview: " + std::string(showPreview ? "enabled" : "disabled"));
-    logInfo("Sharpen strength: " + std::to_string(sharpenStrength));
-    logInfo("Noise reduction: " + std::to_string(noiseReduction));
-    logInfo("Super resolution scale: " + std::to_string(superResolutionScale));
+    logInfo("Input path: ", inputPath);
+    logInfo("Output path: ", outputPath);
+    logInfo("Batch mode: ", batchMode ? "enabled" : "disabled");
+    logInfo("Verbose: ", verbose ? "enabled" : "disabled");
+    logInfo("Show preview: ", showPreview ? "enabled" : "disabled");
+    logInfo("Sharpen strength: ", sharpenStrength);
+    logInfo("Noise reduction: ", noiseReduction);
+    logInfo("Super resolution scale: ", superResolutionScale);
     logInfo("============================");
 }
 
 // Logging utilities
 void Utils::setLogLevel(LogLevel level) {
-    currentLogLevel_ = level;
+    currentLogLevel_.store(level, std::memory_order_relaxed);
 }
 
-void Utils::log(LogLevel level, const std::string& message) {
-    if (level < currentLogLevel_) return;
-    
-    std::string timestamp = getCurrentTimestamp();
-    std::string levelStr = getLogLevelString(level);
-    
-    std::cout << "[" << timestamp << "] [" << levelStr << "] " << message << std::endl;
+void Utils::setLogStream(std::ostream& stream) {
+    Logger::instance().setStream(stream);
+}
+
+void Utils::setAsyncLogging(bool enabled) {
+    Logger::instance().setAsync(enabled);
 }
 
-void Utils::logDebug(const std::string& message) {
-    log(LOG_DEBUG, message);
+void Utils::flushLog() {
+    Logger::instance().flush();
 }
 
-void Utils::logInfo(const std::string& message) {
-    log(LOG_INFO, message);
+void Utils::writeToLogStream(const std::string& text) {
+    Logger::instance().writeRaw(text);
 }
 
-void Utils::logWarning(const std::string& message) {
-    log(LOG_WARNING, message);
+void Utils::setLogRateLimit(int intervalMs) {
+    Logger::instance().setRateLimitInterval(std::chrono::milliseconds(std::max(0, intervalMs)));
+}
+
+void Utils::log(LogLevel level, const std::string& message) {
+    if (!isLogEnabled(level)) return;
+    Logger::instance().submit(level, message);
 }
 
-void Utils::logError(const std::string& message) {
-    log(LOG_ERROR, message);
+bool Utils::allowRateLimited(const std::string& key, size_t& suppressed) {
+    return Logger::instance().allowRateLimited(key, suppressed);
 }
 
 std::string Utils::getLogLevelString(LogLevel level) {